@@ -6,9 +6,701 @@
 #include <thread>
 #include <chrono>
 #include <algorithm> // For case-insensitive string comparison
+#include <map>
+#include <memory>
+#include <memory_resource>
+#include <new>
+#include <random>
+#include <sstream>
+#include <atomic>
+#include <deque>
+#include <mutex>
+#include <charconv>
+#include <type_traits>
+#include <cstdint>
+#include <cmath>
+#include <cstring>
+#include <unordered_map>
+#include <string_view>
+#include <optional>
+#include <csignal>
+#include <pthread.h>
+#include <malloc.h>
+#include <unistd.h>
 
 using namespace std;
 
+// Calls to operator new made by the current thread, so benchmarks can report
+// allocator calls per operation. Only a benchmark build replaces operator new
+// to count them (g++ -DCOUNT_ALLOCATIONS ...); a normal build keeps the
+// standard allocator and the count stays 0. Counting costs one thread-local
+// increment. The replacements stay out of line so the compiler never pairs
+// the malloc and free inside them with new and delete expressions.
+thread_local size_t allocationCalls = 0;
+
+#ifdef COUNT_ALLOCATIONS
+constexpr bool countingAllocations = true;
+
+__attribute__((noinline)) void *operator new(size_t size) {
+    ++allocationCalls;
+    if (void *block = malloc(size == 0 ? 1 : size)) {
+        return block;
+    }
+    throw bad_alloc();
+}
+
+// Over-aligned requests, which is also how pmr::new_delete_resource allocates
+__attribute__((noinline)) void *operator new(size_t size, align_val_t align) {
+    ++allocationCalls;
+    size_t alignment = max(static_cast<size_t>(align), sizeof(void *));
+    void *block = nullptr;
+    if (posix_memalign(&block, alignment, size == 0 ? 1 : size) == 0) {
+        return block;
+    }
+    throw bad_alloc();
+}
+
+__attribute__((noinline)) void operator delete(void *block) noexcept { free(block); }
+__attribute__((noinline)) void operator delete(void *block, size_t) noexcept { free(block); }
+__attribute__((noinline)) void operator delete(void *block, align_val_t) noexcept { free(block); }
+__attribute__((noinline)) void operator delete(void *block, size_t, align_val_t) noexcept { free(block); }
+#else
+constexpr bool countingAllocations = false;
+#endif
+
+// Hot-path instrumentation: per-thread latency histograms, cheap enough to
+// leave on while serving. Stats::dump() merges all threads; it is reachable
+// from the Admin menu and by sending SIGUSR1.
+enum Probe { ProbeOrderFood, ProbeSearchOrder, ProbeGenerateBill, ProbeCount };
+const char *const probeNames[ProbeCount] = {"orderFood", "searchOrder", "generateBill"};
+
+class Stats {
+public:
+    static void record(Probe probe, uint64_t ns) {
+        atomic<uint64_t> &counter = local().buckets[probe][bucketOf(ns)];
+        // Only the owning thread writes its counters, so a plain load/store is enough
+        counter.store(counter.load(memory_order_relaxed) + 1, memory_order_relaxed);
+    }
+
+    static void dump(ostream &out) {
+        vector<uint64_t> merged(bucketCount);
+        out << "\n" << setw(20) << left << "Operation" << setw(12) << "Count" << setw(12) << "p50 us"
+            << setw(12) << "p99 us" << setw(12) << "p999 us" << "\n";
+        for (int probe = 0; probe < ProbeCount; ++probe) {
+            fill(merged.begin(), merged.end(), 0);
+            uint64_t count = 0;
+            {
+                lock_guard<mutex> lock(registryMutex());
+                for (const auto &histograms : threads()) {
+                    for (size_t b = 0; b < bucketCount; ++b) {
+                        uint64_t n = histograms->buckets[probe][b].load(memory_order_relaxed);
+                        merged[b] += n;
+                        count += n;
+                    }
+                }
+            }
+            out << fixed << setprecision(2) << setw(20) << left << probeNames[probe] << setw(12) << count
+                << setw(12) << percentile(merged, count, 0.50) / 1000.0
+                << setw(12) << percentile(merged, count, 0.99) / 1000.0
+                << setw(12) << percentile(merged, count, 0.999) / 1000.0 << "\n";
+        }
+        out.flush();
+    }
+
+private:
+    // Log-linear buckets: exact below 16 ns, then 16 per power of two (about 6% error)
+    static constexpr size_t bucketCount = 976;
+
+    struct ThreadHistograms {
+        atomic<uint64_t> buckets[ProbeCount][bucketCount] = {};
+    };
+
+    static size_t bucketOf(uint64_t ns) {
+        if (ns < 16) {
+            return static_cast<size_t>(ns);
+        }
+        int msb = 63 - __builtin_clzll(ns);
+        return static_cast<size_t>(msb - 3) * 16 + ((ns >> (msb - 4)) & 15);
+    }
+
+    // Midpoint of the bucket's value range
+    static double bucketValue(size_t bucket) {
+        if (bucket < 16) {
+            return static_cast<double>(bucket);
+        }
+        int msb = static_cast<int>(bucket / 16) + 3;
+        double low = static_cast<double>((16 + bucket % 16) << (msb - 4));
+        return low + static_cast<double>(1ULL << (msb - 4)) / 2;
+    }
+
+    static double percentile(const vector<uint64_t> &buckets, uint64_t count, double fraction) {
+        if (count == 0) {
+            return 0.0;
+        }
+        uint64_t rank = static_cast<uint64_t>(fraction * (count - 1)) + 1;
+        uint64_t seen = 0;
+        for (size_t b = 0; b < buckets.size(); ++b) {
+            seen += buckets[b];
+            if (seen >= rank) {
+                return bucketValue(b);
+            }
+        }
+        return bucketValue(buckets.size() - 1);
+    }
+
+    // Never destroyed, so threads still recording while the program exits can use it
+    static mutex &registryMutex() {
+        static mutex *registry = new mutex;
+        return *registry;
+    }
+
+    // Histograms of every thread that has recorded anything; kept after the thread exits
+    static vector<unique_ptr<ThreadHistograms>> &threads() {
+        static auto *all = new vector<unique_ptr<ThreadHistograms>>;
+        return *all;
+    }
+
+    static ThreadHistograms &local() {
+        thread_local ThreadHistograms *mine = nullptr;
+        if (mine == nullptr) {
+            lock_guard<mutex> lock(registryMutex());
+            threads().emplace_back(new ThreadHistograms());
+            mine = threads().back().get();
+        }
+        return *mine;
+    }
+};
+
+// Records how long the enclosing scope took under a probe
+class ScopedLatency {
+public:
+    explicit ScopedLatency(Probe probe) : probe(probe), start(chrono::steady_clock::now()) {}
+    ~ScopedLatency() {
+        auto ns = chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now() - start).count();
+        Stats::record(probe, static_cast<uint64_t>(ns));
+    }
+
+private:
+    Probe probe;
+    chrono::steady_clock::time_point start;
+};
+
+// Prints the stats to stderr on every SIGUSR1 without interrupting service.
+// Call before starting any other thread so they all inherit the blocked signal.
+void startStatsSignalThread() {
+    sigset_t signals;
+    sigemptyset(&signals);
+    sigaddset(&signals, SIGUSR1);
+    pthread_sigmask(SIG_BLOCK, &signals, nullptr);
+    thread([signals] {
+        int signal;
+        while (sigwait(&signals, &signal) == 0) {
+            Stats::dump(cerr);
+        }
+    }).detach();
+}
+
+// Process-wide pool of interned names. Each distinct name is stored once and
+// stands for a 32-bit symbol ID, so a record that repeats a name (an item
+// ordered a million times) holds four bytes instead of its own string. IDs are
+// never released. name() takes no lock: the ID index grows in segments that
+// never move, and an ID only reaches a caller after its entry is written.
+class SymbolTable {
+public:
+    static SymbolTable &instance() {
+        static SymbolTable table;
+        return table;
+    }
+
+    // Returns the ID of name, adding it on first use
+    uint32_t intern(string_view name) {
+        lock_guard<mutex> lock(mtx);
+        auto it = ids.find(name);
+        if (it != ids.end()) {
+            return it->second;
+        }
+        uint32_t id = static_cast<uint32_t>(ids.size());
+        size_t segment = segmentOf(id);
+        if (!segments[segment]) {
+            segments[segment].reset(new string_view[FirstSegmentSize << segment]);
+            indexBytes += (FirstSegmentSize << segment) * sizeof(string_view);
+        }
+        string_view stored = copyName(name);
+        segments[segment][offsetOf(id, segment)] = stored;
+        ids.emplace(stored, id);
+        return id;
+    }
+
+    // Name of an ID returned by intern()
+    string_view name(uint32_t id) const {
+        size_t segment = segmentOf(id);
+        return segments[segment][offsetOf(id, segment)];
+    }
+
+    size_t size() {
+        lock_guard<mutex> lock(mtx);
+        return ids.size();
+    }
+
+    // Bytes held for names, the ID index and the hash map (nodes estimated)
+    size_t bytesUsed() {
+        lock_guard<mutex> lock(mtx);
+        return nameBytes + indexBytes + ids.bucket_count() * sizeof(void *) +
+               ids.size() * (sizeof(pair<string_view, uint32_t>) + 2 * sizeof(void *));
+    }
+
+private:
+    static constexpr size_t FirstSegmentSize = 64; // Each later segment is twice the size of the one before
+    static constexpr size_t BlockSize = 64 * 1024;  // Names are packed into blocks of this size
+
+    mutex mtx;
+    unordered_map<string_view, uint32_t> ids;
+    unique_ptr<string_view[]> segments[27]; // 64 << 26 covers every 32-bit ID
+    vector<unique_ptr<char[]>> blocks;
+    char *block = nullptr; // Block that short names are currently packed into
+    size_t blockUsed = 0;
+    size_t nameBytes = 0;
+    size_t indexBytes = 0;
+
+    SymbolTable() = default;
+
+    static size_t segmentOf(uint32_t id) {
+        return static_cast<size_t>(63 - __builtin_clzll(id + FirstSegmentSize)) - 6;
+    }
+
+    static size_t offsetOf(uint32_t id, size_t segment) { return id + FirstSegmentSize - (FirstSegmentSize << segment); }
+
+    string_view copyName(string_view name) {
+        char *dest;
+        if (name.size() > BlockSize / 4) { // Long names get an allocation of their own
+            blocks.emplace_back(new char[name.size()]);
+            dest = blocks.back().get();
+            nameBytes += name.size();
+        } else {
+            if (block == nullptr || blockUsed + name.size() > BlockSize) {
+                blocks.emplace_back(new char[BlockSize]);
+                block = blocks.back().get();
+                blockUsed = 0;
+                nameBytes += BlockSize;
+            }
+            dest = block + blockUsed;
+            blockUsed += name.size();
+        }
+        memcpy(dest, name.data(), name.size());
+        return string_view(dest, name.size());
+    }
+};
+
+// Unit prices by item symbol, shared by every session in the process.
+// Admin::addInventoryRecord keeps it up to date.
+class PriceCatalog {
+public:
+    static PriceCatalog &instance() {
+        static PriceCatalog catalog;
+        return catalog;
+    }
+
+    void setPrice(uint32_t item, double price) {
+        lock_guard<mutex> lock(mtx);
+        if (item >= prices.size()) {
+            prices.resize(item + 1);
+        }
+        prices[item] = price;
+    }
+
+    // Empty for items without a price, which cannot be ordered
+    optional<double> priceOf(uint32_t item) {
+        lock_guard<mutex> lock(mtx);
+        return item < prices.size() ? prices[item] : nullopt;
+    }
+
+private:
+    mutex mtx;
+    vector<optional<double>> prices; // Indexed by symbol ID
+};
+
+// Orders of one session, stored densely by order number.
+// Numbers are handed out sequentially from base + 1, so the slot of an order
+// is simply orderNumber - base - 1 and lookups never scan. Orders are kept as
+// columns (item symbol, quantity, unit price) and the number is implied by the
+// slot, so a line costs 16 bytes and bills are summed in one pass. The columns
+// come from the given memory resource, normally the session's arena.
+class OrderTable {
+public:
+    struct Order {
+        uint32_t item; // Symbol ID of the item name
+        int quantity;
+        int orderNumber;
+        double unitPrice; // Catalog price when the order was placed
+
+        string_view itemName() const { return SymbolTable::instance().name(item); }
+    };
+
+    explicit OrderTable(int base, pmr::memory_resource *arena = pmr::get_default_resource())
+        : base(base), items(arena), quantities(arena), unitPrices(arena) {}
+
+    // Stores a new order under the next order number and returns it
+    Order add(string_view itemName, int quantity, double unitPrice) {
+        return add(SymbolTable::instance().intern(itemName), quantity, unitPrice);
+    }
+
+    Order add(uint32_t item, int quantity, double unitPrice) {
+        items.push_back(item);
+        quantities.push_back(quantity);
+        unitPrices.push_back(unitPrice);
+        return at(items.size() - 1);
+    }
+
+    // Empty if no order has this number
+    optional<Order> find(int orderNumber) const {
+        // Numbers below base + 1 wrap around to a huge slot and fail the bounds check
+        size_t slot = static_cast<size_t>(static_cast<long long>(orderNumber) - base - 1);
+        if (slot >= items.size()) {
+            return nullopt;
+        }
+        return at(slot);
+    }
+
+    Order at(size_t slot) const {
+        return {items[slot], quantities[slot], base + 1 + static_cast<int>(slot), unitPrices[slot]};
+    }
+
+    // Sum of quantity x unit price. Four independent partial sums let the
+    // compiler vectorise the loop without relaxing floating-point rules.
+    double total() const {
+        const int *q = quantities.data();
+        const double *p = unitPrices.data();
+        size_t n = quantities.size();
+        double s0 = 0.0, s1 = 0.0, s2 = 0.0, s3 = 0.0;
+        size_t i = 0;
+        for (; i + 4 <= n; i += 4) {
+            s0 += q[i] * p[i];
+            s1 += q[i + 1] * p[i + 1];
+            s2 += q[i + 2] * p[i + 2];
+            s3 += q[i + 3] * p[i + 3];
+        }
+        for (; i < n; ++i) {
+            s0 += q[i] * p[i];
+        }
+        return (s0 + s1) + (s2 + s3);
+    }
+
+    // Formats one bill line per order into out. The buffer is sized once up
+    // front and filled through a raw pointer, so a line is a handful of copies.
+    // out is a std::string or a pmr::string.
+    template <typename String>
+    void appendBill(String &out) const {
+        const SymbolTable &symbols = SymbolTable::instance();
+        size_t bound = 0;
+        for (uint32_t item : items) {
+            bound += symbols.name(item).size() + 96; // Fixed text plus the widest numbers
+        }
+        size_t start = out.size();
+        out.resize(start + bound);
+        char *p = &out[start];
+        for (size_t i = 0; i < items.size(); ++i) {
+            p = put(p, "Item: ");
+            p = put(p, symbols.name(items[i]));
+            p = put(p, " | Quantity: ");
+            p = to_chars(p, p + 11, quantities[i]).ptr;
+            p = put(p, " | Price: $");
+            p = putPrice(p, quantities[i] * unitPrices[i]);
+            p = put(p, " | Order Number: ");
+            p = to_chars(p, p + 11, base + 1 + static_cast<int>(i)).ptr;
+            *p++ = '\n';
+        }
+        out.resize(static_cast<size_t>(p - out.data()));
+    }
+
+    static void appendNumber(string &out, int value) {
+        char digits[16];
+        auto result = to_chars(digits, digits + sizeof(digits), value);
+        out.append(digits, result.ptr);
+    }
+
+    template <typename String>
+    static void appendPrice(String &out, double value) {
+        char digits[32];
+        out.append(digits, putPrice(digits, value));
+    }
+
+    size_t size() const { return items.size(); }
+    bool empty() const { return items.empty(); }
+
+    // Drops every order and hands the storage back to the memory resource
+    void clear() {
+        pmr::vector<uint32_t>(items.get_allocator()).swap(items);
+        pmr::vector<int>(quantities.get_allocator()).swap(quantities);
+        pmr::vector<double>(unitPrices.get_allocator()).swap(unitPrices);
+    }
+
+private:
+    int base;
+    pmr::vector<uint32_t> items;
+    pmr::vector<int> quantities;
+    pmr::vector<double> unitPrices;
+
+    template <size_t N>
+    static char *put(char *p, const char (&text)[N]) {
+        memcpy(p, text, N - 1);
+        return p + N - 1;
+    }
+
+    static char *put(char *p, string_view text) {
+        memcpy(p, text.data(), text.size());
+        return p + text.size();
+    }
+
+    // Writes value as whole cents ("12.50"); integer formatting is much cheaper than floating point
+    static char *putPrice(char *p, double value) {
+        long long cents = llround(value * 100);
+        if (cents < 0) {
+            *p++ = '-';
+            cents = -cents;
+        }
+        p = to_chars(p, p + 20, cents / 100).ptr;
+        *p++ = '.';
+        *p++ = static_cast<char>('0' + cents % 100 / 10);
+        *p++ = static_cast<char>('0' + cents % 10);
+        return p;
+    }
+};
+
+// Renders rows of cells as an aligned text table or as CSV, TSV or JSON.
+// Cells are appended to one buffer as they are added (numbers through
+// to_chars) and column widths are tracked at the same time, so rendering is
+// a single pass into a reusable output buffer that is written out in large
+// blocks rather than flushed per row.
+class TableWriter {
+public:
+    enum class Format { Text, Csv, Tsv, Json };
+
+    explicit TableWriter(vector<string> headers, size_t minWidth = 10) {
+        for (auto &header : headers) {
+            size_t width = max(minWidth, header.size() + 1);
+            columns.push_back({move(header), string(), width, false});
+        }
+    }
+
+    // Parses "table", "csv", "tsv" or "json"
+    static bool parseFormat(string_view name, Format &format) {
+        const pair<string_view, Format> names[] = {
+            {"table", Format::Text}, {"csv", Format::Csv}, {"tsv", Format::Tsv}, {"json", Format::Json}};
+        for (const auto &entry : names) {
+            if (entry.first == name) {
+                format = entry.second;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // Text shown before every cell of a column in the aligned table only, such as "$".
+    // Set it before adding rows.
+    void setPrefix(size_t column, string prefix) {
+        columns[column].width = max(columns[column].width, prefix.size() + 1);
+        columns[column].prefix = move(prefix);
+    }
+
+    // Cells fill rows left to right
+    TableWriter &add(string_view text) { return addCell(text, false); }
+
+    template <typename Number, typename = enable_if_t<is_arithmetic_v<Number>>>
+    TableWriter &add(Number value) {
+        char digits[32];
+        auto result = to_chars(digits, digits + sizeof(digits), value);
+        return addCell(string_view(digits, static_cast<size_t>(result.ptr - digits)), true);
+    }
+
+    size_t rows() const { return ends.size() / columns.size(); }
+
+    // Writes count rows starting at row first
+    void render(ostream &out, Format format, size_t first = 0, size_t count = SIZE_MAX) const {
+        size_t last = first + min(count, rows() > first ? rows() - first : 0);
+        buffer.clear();
+        if (format == Format::Text) {
+            buffer += '\n';
+            appendRule();
+            for (size_t c = 0; c < columns.size(); ++c) {
+                appendPadded(columns[c].header, columns[c].width, c + 1 == columns.size());
+            }
+            buffer += '\n';
+            appendRule();
+        } else if (format == Format::Json) {
+            buffer += '[';
+        } else {
+            char separator = format == Format::Csv ? ',' : '\t';
+            for (size_t c = 0; c < columns.size(); ++c) {
+                if (c > 0) {
+                    buffer += separator;
+                }
+                appendEscaped(columns[c].header, format);
+            }
+            buffer += '\n';
+        }
+
+        for (size_t r = first; r < last; ++r) {
+            if (format == Format::Text) {
+                for (size_t c = 0; c < columns.size(); ++c) {
+                    size_t start = buffer.size();
+                    buffer += columns[c].prefix;
+                    buffer.append(cell(r, c));
+                    padTo(start + columns[c].width, c + 1 == columns.size());
+                }
+            } else if (format == Format::Json) {
+                buffer += r == first ? "\n  {" : ",\n  {";
+                for (size_t c = 0; c < columns.size(); ++c) {
+                    buffer += c == 0 ? "\"" : ", \"";
+                    appendEscaped(columns[c].header, format);
+                    buffer += "\": ";
+                    if (columns[c].numeric) {
+                        buffer.append(cell(r, c));
+                    } else {
+                        buffer += '"';
+                        appendEscaped(cell(r, c), format);
+                        buffer += '"';
+                    }
+                }
+                buffer += '}';
+            } else {
+                for (size_t c = 0; c < columns.size(); ++c) {
+                    if (c > 0) {
+                        buffer += format == Format::Csv ? ',' : '\t';
+                    }
+                    appendEscaped(cell(r, c), format);
+                }
+            }
+            if (format != Format::Json) {
+                buffer += '\n';
+            }
+            if (buffer.size() >= flushBytes) {
+                out.write(buffer.data(), static_cast<streamsize>(buffer.size()));
+                buffer.clear();
+            }
+        }
+
+        if (format == Format::Text) {
+            appendRule();
+        } else if (format == Format::Json) {
+            buffer += last > first ? "\n]\n" : "]\n";
+        }
+        out.write(buffer.data(), static_cast<streamsize>(buffer.size()));
+    }
+
+    // Shows the aligned table a page at a time, asking before each further page
+    void page(ostream &out, istream &in, size_t pageSize) const {
+        size_t pages = max<size_t>(1, (rows() + pageSize - 1) / pageSize);
+        for (size_t p = 0; p < pages; ++p) {
+            render(out, Format::Text, p * pageSize, pageSize);
+            if (p + 1 < pages) {
+                out << "Page " << p + 1 << " of " << pages << ". Enter n for the next page or anything else to stop: ";
+                string answer;
+                if (!(in >> answer) || (answer != "n" && answer != "N")) {
+                    break;
+                }
+            }
+        }
+    }
+
+private:
+    static bool needsEscape(char c, Format format) {
+        switch (format) {
+        case Format::Csv:
+            return c == ',' || c == '"' || c == '\r' || c == '\n';
+        case Format::Tsv:
+            return c == '\t' || c == '\r' || c == '\n';
+        default:
+            return c == '"' || c == '\\' || static_cast<unsigned char>(c) < 0x20;
+        }
+    }
+
+    struct Column {
+        string header;
+        string prefix;
+        size_t width; // Widest cell plus one space
+        bool numeric; // Written unquoted in JSON
+    };
+
+    static constexpr size_t flushBytes = 64 * 1024;
+
+    vector<Column> columns;
+    string text;          // Every cell back to back
+    vector<size_t> ends;  // End of each cell in text, row by row
+    mutable string buffer; // Output being rendered
+
+    TableWriter &addCell(string_view value, bool numeric) {
+        Column &column = columns[ends.size() % columns.size()];
+        column.width = max(column.width, column.prefix.size() + value.size() + 1);
+        column.numeric = numeric;
+        text.append(value);
+        ends.push_back(text.size());
+        return *this;
+    }
+
+    string_view cell(size_t row, size_t column) const {
+        size_t index = row * columns.size() + column;
+        size_t start = index == 0 ? 0 : ends[index - 1];
+        return string_view(text).substr(start, ends[index] - start);
+    }
+
+    void appendRule() const {
+        size_t width = 0;
+        for (const auto &column : columns) {
+            width += column.width;
+        }
+        buffer.append(max<size_t>(width - 1, 45), '=');
+        buffer += '\n';
+    }
+
+    // The last column is not padded, so lines carry no trailing spaces
+    void appendPadded(string_view value, size_t width, bool lastColumn) const {
+        size_t start = buffer.size();
+        buffer.append(value);
+        padTo(start + width, lastColumn);
+    }
+
+    void padTo(size_t end, bool lastColumn) const {
+        if (!lastColumn && buffer.size() < end) {
+            buffer.append(end - buffer.size(), ' ');
+        }
+    }
+
+    // Most cells need no escaping, so they are checked first and appended whole
+    void appendEscaped(string_view value, Format format) const {
+        if (none_of(value.begin(), value.end(), [format](char c) { return needsEscape(c, format); })) {
+            buffer.append(value);
+            return;
+        }
+        if (format == Format::Csv) {
+            buffer += '"';
+            for (char c : value) {
+                buffer += c;
+                if (c == '"') {
+                    buffer += '"';
+                }
+            }
+            buffer += '"';
+        } else if (format == Format::Tsv) {
+            for (char c : value) {
+                buffer += c == '\t' || c == '\n' || c == '\r' ? ' ' : c;
+            }
+        } else {
+            for (char c : value) {
+                if (c == '"' || c == '\\') {
+                    buffer += '\\';
+                    buffer += c;
+                } else if (static_cast<unsigned char>(c) < 0x20) {
+                    char escape[8];
+                    snprintf(escape, sizeof(escape), "\\u%04x", c);
+                    buffer += escape;
+                } else {
+                    buffer += c;
+                }
+            }
+        }
+    }
+};
+
 // Base class Person
 class Person {
 protected:
@@ -20,6 +712,14 @@ public:
     Person(string n, int i, string pass) : name(n), id(i), password(pass) {}
     Person(string n, string pass) : name(n), password(pass) {}  // Corrected constructor for Admin
     virtual void displayMenu() = 0; // Pure virtual function
+
+protected:
+    // Reuses the strings' capacity when a pooled object is handed to a new login
+    void assign(const string &n, int i, const string &pass) {
+        name = n;
+        id = i;
+        password = pass;
+    }
 };
 
 // Derived class Admin
@@ -33,13 +733,14 @@ private:
     };
 
     struct InventoryItem {
-        string itemName;
+        uint32_t item; // Symbol ID of the item name
         int quantity;
         double price;
     };
 
     vector<EmployeeData> employeeData;
     vector<InventoryItem> inventory;
+    static constexpr size_t pageSize = 20; // Table rows shown before asking for the next page
 
     // Helper for case-insensitive string comparison
     bool caseInsensitiveMatch(const string &a, const string &b) {
@@ -47,20 +748,58 @@ private:
                      [](char a, char b) { return tolower(a) == tolower(b); });
     }
 
+    bool nameTaken(const string &empName) {
+        for (const auto &emp : employeeData) {
+            if (caseInsensitiveMatch(emp.name, empName)) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    bool idTaken(int empID) {
+        for (const auto &emp : employeeData) {
+            if (emp.empID == empID) {
+                return true;
+            }
+        }
+        return false;
+    }
+
 public:
     Admin(string n, string pass) : Person(n, pass) {}
 
+    // Starts a new login on a pooled Admin; like a new Admin it starts with no records
+    void reset(const string &n, const string &pass) {
+        assign(n, 0, pass);
+        employeeData.clear();
+        inventory.clear();
+    }
+
+    // Adds an employee without prompting; returns an error message, empty on success
+    string addEmployeeRecord(const string &empName, int age, int empID, double salary) {
+        if (nameTaken(empName)) {
+            return "Employee with this name already exists.";
+        }
+        if (age > 85) {
+            return "Invalid age. Age cannot be greater than 85.";
+        }
+        if (idTaken(empID)) {
+            return "Employee with this ID already exists.";
+        }
+        employeeData.push_back({empName, age, empID, salary});
+        return "";
+    }
+
     void addEmployee() {
         EmployeeData newEmp;
         cout << "Enter Employee Name: ";
         cin >> newEmp.name;
 
         // Check if the name already exists
-        for (const auto &emp : employeeData) {
-            if (caseInsensitiveMatch(emp.name, newEmp.name)) {
-                cout << "Employee with this name already exists. Please enter a different name.\n";
-                return;
-            }
+        if (nameTaken(newEmp.name)) {
+            cout << "Employee with this name already exists. Please enter a different name.\n";
+            return;
         }
 
         // Age validation
@@ -76,11 +815,9 @@ public:
         cin >> newEmp.empID;
 
         // Check if the ID already exists
-        for (const auto &emp : employeeData) {
-            if (emp.empID == newEmp.empID) {
-                cout << "Employee with this ID already exists. Please enter a different ID.\n";
-                return;
-            }
+        if (idTaken(newEmp.empID)) {
+            cout << "Employee with this ID already exists. Please enter a different ID.\n";
+            return;
         }
 
         cout << "Enter Employee Salary: ";
@@ -152,41 +889,51 @@ public:
     }
 
     void viewEmployees() {
-        cout << "\n=============================================\n";
-        cout << setw(10) << left << "Name" << setw(10) << "Age" << setw(10) << "ID" << setw(10) << "Salary" << endl;
-        cout << "=============================================\n";
+        employeeTable().page(cout, cin, pageSize);
+    }
+
+    // Columns grow to fit the longest name, so long names no longer shift the row
+    TableWriter employeeTable() const {
+        TableWriter table({"Name", "Age", "ID", "Salary"});
+        table.setPrefix(3, "$");
         for (const auto &emp : employeeData) {
-            cout << setw(10) << left << emp.name
-                 << setw(10) << emp.age
-                 << setw(10) << emp.empID
-                 << "$" << setw(9) << emp.salary << endl;
+            table.add(emp.name).add(emp.age).add(emp.empID).add(emp.salary);
         }
-        cout << "=============================================\n";
+        return table;
     }
 
     void addItemToInventory() {
-        InventoryItem newItem;
+        string itemName;
+        int quantity;
+        double price;
         cout << "Enter item name: ";
-        cin >> newItem.itemName;
+        cin >> itemName;
         cout << "Enter quantity: ";
-        cin >> newItem.quantity;
+        cin >> quantity;
         cout << "Enter price: ";
-        cin >> newItem.price;
+        cin >> price;
 
-        inventory.push_back(newItem);
+        addInventoryRecord(itemName, quantity, price);
         cout << "Item added to inventory successfully!\n";
     }
 
+    void addInventoryRecord(const string &itemName, int quantity, double price) {
+        uint32_t item = SymbolTable::instance().intern(itemName);
+        inventory.push_back({item, quantity, price});
+        PriceCatalog::instance().setPrice(item, price);
+    }
+
     void viewInventory() {
-        cout << "\n=============================================\n";
-        cout << setw(10) << left << "Item Name" << setw(10) << "Quantity" << setw(10) << "Price" << endl;
-        cout << "=============================================\n";
+        inventoryTable().page(cout, cin, pageSize);
+    }
+
+    TableWriter inventoryTable() const {
+        TableWriter table({"Item Name", "Quantity", "Price"});
+        table.setPrefix(2, "$");
         for (const auto &item : inventory) {
-            cout << setw(10) << left << item.itemName
-                 << setw(10) << item.quantity
-                 << "$" << setw(9) << item.price << endl;
+            table.add(SymbolTable::instance().name(item.item)).add(item.quantity).add(item.price);
         }
-        cout << "=============================================\n";
+        return table;
     }
 
     vector<InventoryItem>& getInventory() { return inventory; }
@@ -195,7 +942,7 @@ public:
         int choice;
         do {
             cout << "\nAdmin Menu:\n1. Add Employee\n2. Delete Employee\n3. Edit Employee\n4. View Employees\n"
-                 << "5. Add Inventory Item\n6. View Inventory\n7. Exit\n";
+                 << "5. Add Inventory Item\n6. View Inventory\n7. View Stats\n8. Exit\n";
             cin >> choice;
             switch (choice) {
                 case 1: addEmployee(); break;
@@ -204,43 +951,60 @@ public:
                 case 4: viewEmployees(); break;
                 case 5: addItemToInventory(); break;
                 case 6: viewInventory(); break;
-                case 7: cout << "Exiting Admin Menu.\n"; break;
+                case 7: Stats::dump(cout); break;
+                case 8: cout << "Exiting Admin Menu.\n"; break;
                 default: cout << "Invalid option!\n";
             }
-        } while (choice != 7);
+        } while (choice != 8);
     }
 };
 
 // Derived class Employee
 class Employee : public Person {
 private:
-    struct Order {
-        string itemName;  // Name of the food item
-        int quantity;     // Quantity of the food item
-        int orderNumber;  // Unique order number
-    };
+    using Order = OrderTable::Order;
 
-    vector<Order> foodItems; // Vector to store food orders
-    int orderCounter;        // Counter for generating unique order numbers
+    // Everything a login allocates comes from its arena and is released in one
+    // go at logout. The first block lives inside the object, so on a pooled
+    // Employee a typical session never calls the allocator.
+    alignas(max_align_t) char arenaBlock[2048];
+    pmr::monotonic_buffer_resource sessionArena;
+    pmr::string billText; // Reused by every bill of the session
+    OrderTable foodItems; // Food orders, numbered from 1001
 
 public:
-    Employee(string n, int i, string pass) : Person(n, i, pass), orderCounter(1000) {}
+    Employee(string n, int i, string pass)
+        : Person(n, i, pass), sessionArena(arenaBlock, sizeof(arenaBlock)), billText(&sessionArena),
+          foodItems(1000, &sessionArena) {}
+
+    // Starts a new login on a pooled Employee
+    void reset(const string &n, int i, const string &pass) { assign(n, i, pass); }
+
+    // Drops the session's orders and releases its arena
+    void endSession() {
+        foodItems.clear();
+        pmr::string(&sessionArena).swap(billText);
+        sessionArena.release();
+    }
 
     // Function for ordering food
     void orderFood() {
-        Order newOrder;
+        string itemName;
+        int quantity;
         char continueOrder;
 
         do {
             cout << "Enter food item: ";
-            cin >> newOrder.itemName; // Input food item name
+            cin >> itemName; // Input food item name
             cout << "Enter quantity: ";
-            cin >> newOrder.quantity;  // Input quantity
+            cin >> quantity;  // Input quantity
 
-            newOrder.orderNumber = ++orderCounter; // Generate unique order number
-            foodItems.push_back(newOrder); // Add order to the vector
-
-            cout << "Order placed successfully! Order Number: " << newOrder.orderNumber << endl;
+            int orderNumber = placeOrder(itemName, quantity);
+            if (orderNumber == 0) {
+                cout << itemName << " is not in the inventory, so it has no price. Order not placed.\n";
+            } else {
+                cout << "Order placed successfully! Order Number: " << orderNumber << endl;
+            }
 
             cout << "Do you want to order another item? (y/n): ";
             cin >> continueOrder; // Ask if the user wants to order more items
@@ -248,31 +1012,44 @@ public:
         } while (continueOrder == 'y' || continueOrder == 'Y');
     }
 
+    // Records one order without prompting and returns its order number,
+    // or 0 if the item has no price
+    int placeOrder(const string &itemName, int quantity) {
+        ScopedLatency latency(ProbeOrderFood);
+        uint32_t item = SymbolTable::instance().intern(itemName);
+        optional<double> price = PriceCatalog::instance().priceOf(item);
+        if (!price) {
+            return 0;
+        }
+        return foodItems.add(item, quantity, *price).orderNumber;
+    }
+
     // Function to search for an order by order number
-    void searchOrder(int num) {
-        for (const auto &order : foodItems) {
-            if (order.orderNumber == num) {
-                cout << "Order found: Item: " << order.itemName
-                     << ", Quantity: " << order.quantity
-                     << ", Order Number: " << order.orderNumber << endl;
-                return; // Exit the function if the order is found
-            }
+    bool searchOrder(int num) {
+        ScopedLatency latency(ProbeSearchOrder);
+        optional<Order> order = foodItems.find(num);
+        if (!order) {
+            return false; // Order number not found
         }
-        throw invalid_argument("Order number not found"); // Throw error if not found
+        cout << "Order found: Item: " << order->itemName()
+             << ", Quantity: " << order->quantity
+             << ", Order Number: " << order->orderNumber << endl;
+        return true;
     }
 
-    // Function to generate a bill for recent orders
+    // Function to generate a bill for recent orders, priced from the catalog
     void generateBill() {
-        cout << "Generating bill for recent orders:\n";
-        for (const auto &order : foodItems) {
-            cout << "Item: " << order.itemName
-                 << " | Quantity: " << order.quantity
-                 << " | Price: $" << (rand() % 50 + 10) * order.quantity // Example price generation
-                 << " | Order Number: " << order.orderNumber << endl;
-        }
-        cout << "Bill generated successfully!\n";
+        ScopedLatency latency(ProbeGenerateBill);
+        billText = "Generating bill for recent orders:\n";
+        foodItems.appendBill(billText);
+        billText += "Total: $";
+        OrderTable::appendPrice(billText, foodItems.total());
+        billText += "\nBill generated successfully!\n";
+        cout.write(billText.data(), static_cast<streamsize>(billText.size())); // One write for the whole bill
     }
 
+    double billTotal() const { return foodItems.total(); }
+
     void displayMenu() override {
         int choice;
         do {
@@ -284,10 +1061,8 @@ public:
                     int orderNumber;
                     cout << "Enter order number to search: ";
                     cin >> orderNumber;
-                    try {
-                        searchOrder(orderNumber);
-                    } catch (const invalid_argument &e) {
-                        cout << e.what() << endl; // Display error if order not found
+                    if (!searchOrder(orderNumber)) {
+                        cout << "Order number not found" << endl;
                     }
                     break;
                 }
@@ -299,11 +1074,58 @@ public:
     }
 };
 
+// Recycles Admin and Employee objects across logins. A released object keeps
+// its strings, tables and arena block, so the next login reuses them instead
+// of allocating. Only the console's main loop uses it, from one thread.
+class PersonPool {
+public:
+    static PersonPool &instance() {
+        static PersonPool pool;
+        return pool;
+    }
+
+    Admin *admin(const string &name, const string &password) {
+        if (freeAdmins.empty()) {
+            return new Admin(name, password);
+        }
+        Admin *admin = freeAdmins.back().release();
+        freeAdmins.pop_back();
+        admin->reset(name, password);
+        return admin;
+    }
+
+    Employee *employee(const string &name, int id, const string &password) {
+        if (freeEmployees.empty()) {
+            return new Employee(name, id, password);
+        }
+        Employee *employee = freeEmployees.back().release();
+        freeEmployees.pop_back();
+        employee->reset(name, id, password);
+        return employee;
+    }
+
+    // Ends the login; user must come from this pool
+    void release(Person *user) {
+        if (Employee *employee = dynamic_cast<Employee *>(user)) {
+            employee->endSession();
+            freeEmployees.emplace_back(employee);
+        } else if (Admin *admin = dynamic_cast<Admin *>(user)) {
+            freeAdmins.emplace_back(admin);
+        }
+    }
+
+private:
+    vector<unique_ptr<Admin>> freeAdmins;
+    vector<unique_ptr<Employee>> freeEmployees;
+
+    PersonPool() = default;
+};
+
 // Function to authenticate Admin
 bool authenticateAdmin(string username, string password, Person *&user) {
     string storedPassword = "admin123"; // Example admin password
     if (username == "admin" && password == storedPassword) {
-        user = new Admin(username, password); // Create Admin object
+        user = PersonPool::instance().admin(username, password);
         return true; // Successful admin login
     }
     cout << "Authentication failed. Please try again.\n";
@@ -314,15 +1136,453 @@ bool authenticateAdmin(string username, string password, Person *&user) {
 bool authenticateEmployee(string username, int id, string password, Person *&user, Admin *adminRef) {
     string storedPassword = "emp123"; // Example employee password
     if (password == storedPassword) {
-        user = new Employee(username, id, password); // Corrected constructor usage
+        user = PersonPool::instance().employee(username, id, password);
         return true; // Successful employee login
     }
     cout << "Authentication failed. Please try again.\n";
     return false; // Failed employee login
 }
 
+// Discards everything written to it (used by --quiet and benchmarks)
+class NullBuffer : public streambuf {
+protected:
+    int overflow(int c) override { return traits_type::not_eof(c); }
+    streamsize xsputn(const char *, streamsize n) override { return n; }
+};
+
+// Bills every open session at once and returns the summary as one block of text
+string billAllSessions(const map<int, unique_ptr<Employee>> &sessions) {
+    string summary;
+    double grandTotal = 0.0;
+    for (const auto &entry : sessions) {
+        double total = entry.second->billTotal();
+        grandTotal += total;
+        summary += "Employee ";
+        OrderTable::appendNumber(summary, entry.first);
+        summary += ": $";
+        OrderTable::appendPrice(summary, total);
+        summary += '\n';
+    }
+    summary += "All sessions: $";
+    OrderTable::appendPrice(summary, grandTotal);
+    summary += '\n';
+    return summary;
+}
+
+// Runs commands without prompts, one per line:
+//   add-employee <name> <age> <id> <salary>
+//   add-item <name> <quantity> <price>
+//   order <employee-id> <item> <quantity>
+//   search <employee-id> <order-number>
+//   bill <employee-id>
+//   bill-all                      (totals for every open session)
+//   view-employees [table|csv|tsv|json]
+//   view-inventory [table|csv|tsv|json]
+// Blank lines and lines starting with # are skipped. Each employee ID gets its
+// own session. Prints per-operation latency and total throughput at the end.
+int runBatch(istream &in, bool quiet) {
+    using Clock = chrono::steady_clock;
+    Admin admin("admin", "admin123");
+    map<int, unique_ptr<Employee>> sessions;
+    map<string, vector<double>> latencies; // Operation -> microseconds per call
+    map<string, int> failures;
+
+    auto session = [&sessions](int empID) -> Employee & {
+        unique_ptr<Employee> &emp = sessions[empID];
+        if (!emp) {
+            emp.reset(new Employee("employee" + to_string(empID), empID, "emp123"));
+        }
+        return *emp;
+    };
+
+    NullBuffer nullBuffer;
+    streambuf *console = cout.rdbuf();
+    if (quiet) {
+        cout.rdbuf(&nullBuffer);
+    }
+
+    string line;
+    int lineNumber = 0;
+    auto batchStart = Clock::now();
+    while (getline(in, line)) {
+        ++lineNumber;
+        istringstream args(line);
+        string op;
+        if (!(args >> op) || op[0] == '#') {
+            continue;
+        }
+
+        string text, error;
+        int a = 0, b = 0;
+        double price = 0.0;
+        auto start = Clock::now();
+        if (op == "add-employee" && args >> text >> a >> b >> price) {
+            error = admin.addEmployeeRecord(text, a, b, price);
+        } else if (op == "add-item" && args >> text >> a >> price) {
+            admin.addInventoryRecord(text, a, price);
+        } else if (op == "order" && args >> a >> text >> b) {
+            int orderNumber = session(a).placeOrder(text, b);
+            if (orderNumber == 0) {
+                error = text + " has no price";
+            } else {
+                cout << "Order placed successfully! Order Number: " << orderNumber << endl;
+            }
+        } else if (op == "search" && args >> a >> b) {
+            if (!session(a).searchOrder(b)) {
+                error = "Order number not found";
+            }
+        } else if (op == "bill" && args >> a) {
+            session(a).generateBill();
+        } else if (op == "bill-all") {
+            cout << billAllSessions(sessions);
+        } else if (op == "view-employees" || op == "view-inventory") {
+            TableWriter::Format format = TableWriter::Format::Text;
+            if (args >> text && !TableWriter::parseFormat(text, format)) {
+                error = "unknown format " + text;
+            } else {
+                (op == "view-employees" ? admin.employeeTable() : admin.inventoryTable()).render(cout, format);
+            }
+        } else {
+            cerr << "line " << lineNumber << ": unknown or incomplete command: " << line << "\n";
+            continue;
+        }
+        latencies[op].push_back(chrono::duration<double, micro>(Clock::now() - start).count());
+        if (!error.empty()) {
+            ++failures[op];
+            cerr << "line " << lineNumber << ": " << op << " failed: " << error << "\n";
+        }
+    }
+    double totalSec = chrono::duration<double>(Clock::now() - batchStart).count();
+    cout.rdbuf(console);
+
+    size_t totalOps = 0;
+    cout << "\n" << setw(16) << left << "Operation" << setw(10) << "Count" << setw(10) << "Failed"
+         << setw(12) << "Mean us" << setw(12) << "p50 us" << setw(12) << "p99 us" << "\n";
+    for (auto &entry : latencies) {
+        vector<double> &samples = entry.second;
+        sort(samples.begin(), samples.end());
+        double sum = 0.0;
+        for (double sample : samples) {
+            sum += sample;
+        }
+        totalOps += samples.size();
+        cout << fixed << setprecision(2) << setw(16) << left << entry.first << setw(10) << samples.size()
+             << setw(10) << failures[entry.first] << setw(12) << sum / samples.size()
+             << setw(12) << samples[samples.size() / 2] << setw(12) << samples[samples.size() * 99 / 100] << "\n";
+    }
+    cout << "Total: " << totalOps << " operations in " << totalSec << " s ("
+         << static_cast<long long>(totalSec > 0 ? totalOps / totalSec : 0) << " ops/s)\n";
+    return 0;
+}
+
+// Replays scripted console input through the real Admin and Employee methods
+// and reports latency per operation as CSV:
+// variant,operation,records,calls,p50_us,p99_us,ops_per_sec
+class OpsBenchmark {
+public:
+    OpsBenchmark(string variant, size_t records) : variant(move(variant)), records(records) {}
+
+    // Feeds input to cin for one call of fn and records how long the call took
+    template <typename Fn>
+    void replay(const string &operation, const string &input, Fn fn) {
+        istringstream in(input);
+        streambuf *console = cin.rdbuf(in.rdbuf());
+        auto start = chrono::steady_clock::now();
+        fn();
+        double us = chrono::duration<double, micro>(chrono::steady_clock::now() - start).count();
+        cin.rdbuf(console);
+        samplesFor(operation).push_back(us);
+    }
+
+    void report(ostream &out) {
+        out << "variant,operation,records,calls,p50_us,p99_us,ops_per_sec\n";
+        for (auto &entry : samples) {
+            vector<double> &us = entry.second;
+            sort(us.begin(), us.end());
+            double total = 0.0;
+            for (double sample : us) {
+                total += sample;
+            }
+            out << variant << "," << entry.first << "," << records << "," << us.size() << ","
+                << fixed << setprecision(3) << us[us.size() / 2] << "," << us[us.size() * 99 / 100] << ","
+                << setprecision(0) << (total > 0 ? us.size() * 1e6 / total : 0.0) << "\n";
+        }
+    }
+
+private:
+    string variant;
+    size_t records;
+    vector<pair<string, vector<double>>> samples; // In the order operations were first run
+
+    vector<double> &samplesFor(const string &operation) {
+        for (auto &entry : samples) {
+            if (entry.first == operation) {
+                return entry.second;
+            }
+        }
+        samples.emplace_back(operation, vector<double>());
+        return samples.back().second;
+    }
+};
+
+// Every Admin and Employee operation at the given data size
+void benchOperations(size_t records) {
+    const int viewCalls = 20;
+    string allPages; // Answers every page prompt so the views print the whole table
+    for (size_t rows = 0; rows < records; rows += 20) {
+        allPages += "n\n";
+    }
+    OpsBenchmark bench("test", records);
+    NullBuffer nullBuffer;
+    streambuf *console = cout.rdbuf(&nullBuffer);
+    {
+        Admin admin("admin", "admin123");
+        for (size_t i = 0; i < records; ++i) {
+            bench.replay("add-employee", "Emp" + to_string(i) + "\n30\n" + to_string(i) + "\n1000\n",
+                         [&admin] { admin.addEmployee(); });
+        }
+        for (size_t i = 0; i < records; ++i) {
+            bench.replay("edit-employee", to_string(i) + "\nEmp" + to_string(i) + "\n31\n1100\n",
+                         [&admin] { admin.editEmployee(); });
+        }
+        for (int i = 0; i < viewCalls; ++i) {
+            bench.replay("view-employees", allPages, [&admin] { admin.viewEmployees(); });
+        }
+        for (size_t i = 0; i < records; ++i) {
+            bench.replay("add-item", "Item" + to_string(i) + "\n100\n1.5\n", [&admin] { admin.addItemToInventory(); });
+        }
+        for (int i = 0; i < viewCalls; ++i) {
+            bench.replay("view-inventory", allPages, [&admin] { admin.viewInventory(); });
+        }
+        for (size_t i = 0; i < records; ++i) {
+            string input = i % 2 ? "1\nEmp" + to_string(i) + "\n" : "2\n" + to_string(i) + "\n";
+            bench.replay("delete-employee", input, [&admin] { admin.deleteEmployee(); });
+        }
+    }
+    {
+        Employee emp("bench", 1, "emp123");
+        for (size_t i = 0; i < records; ++i) {
+            bench.replay("order", "Item" + to_string(i % 50) + "\n2\nn\n", [&emp] { emp.orderFood(); });
+        }
+        for (size_t i = 0; i < records; ++i) {
+            int orderNumber = 1001 + static_cast<int>(i);
+            bench.replay("search-order", "", [&emp, orderNumber] { emp.searchOrder(orderNumber); });
+        }
+        for (int i = 0; i < viewCalls; ++i) {
+            bench.replay("generate-bill", "", [&emp] { emp.generateBill(); });
+        }
+    }
+    cout.rdbuf(console);
+    bench.report(cout);
+}
+
+// Billing 1M-line sessions: the old rand()-priced, line-at-a-time path
+// against catalog prices summed over columns and formatted into one buffer
+void benchBill(size_t lines) {
+    using Clock = chrono::steady_clock;
+    OrderTable table(1000);
+    for (size_t i = 0; i < lines; ++i) {
+        table.add("Item" + to_string(i % 50), 1 + static_cast<int>(i % 4), 1.25 + (i % 50) * 0.5);
+    }
+    NullBuffer nullBuffer;
+    ostream discard(&nullBuffer);
+
+    auto start = Clock::now();
+    for (size_t i = 0; i < table.size(); ++i) {
+        OrderTable::Order order = table.at(i);
+        discard << "Item: " << order.itemName()
+                << " | Quantity: " << order.quantity
+                << " | Price: $" << (rand() % 50 + 10) * order.quantity
+                << " | Order Number: " << order.orderNumber << endl;
+    }
+    double oldMs = chrono::duration<double, milli>(Clock::now() - start).count();
+
+    start = Clock::now();
+    double total = table.total();
+    double sumMs = chrono::duration<double, milli>(Clock::now() - start).count();
+
+    start = Clock::now();
+    string bill;
+    table.appendBill(bill);
+    discard.write(bill.data(), static_cast<streamsize>(bill.size()));
+    double newMs = chrono::duration<double, milli>(Clock::now() - start).count();
+
+    cout << setw(12) << left << "Lines" << setw(18) << "Old bill ms" << setw(18) << "New bill ms"
+         << setw(18) << "Total only ms" << "Total" << "\n";
+    cout << fixed << setprecision(3) << setw(12) << left << lines << setw(18) << oldMs << setw(18) << newMs
+         << setw(18) << sumMs << setprecision(2) << total << "\n";
+}
+
+// Login churn: a rush of 10000 logins per minute with sessions lasting about
+// 3 s keeps 500 employees logged in. Each login places 1-20 orders and prints
+// a bill; once 500 are logged in, every new login logs the oldest one out.
+// The rush is replayed as fast as possible, once per way of managing sessions;
+// variant picks one of them, and -1 runs each in a child process.
+void benchChurn(size_t logins, int variant) {
+    const size_t live = 500;
+    const string menu[] = {"Masala Dosa", "Paneer Butter Masala", "Vegetable Biryani", "Filter Coffee",
+                           "Idli Sambar", "Chicken Fried Rice", "Gobi Manchurian", "Mango Lassi",
+                           "Veg Hakka Noodles", "Samosa", "Chole Bhature", "Lemon Rice"};
+    const size_t menuSize = sizeof(menu) / sizeof(menu[0]);
+
+    // An Employee as it was before sessions had arenas and were pooled
+    struct HeapSession {
+        string name;
+        int id;
+        string password;
+        OrderTable foodItems{1000};
+
+        void placeOrder(const string &itemName, int quantity) {
+            uint32_t item = SymbolTable::instance().intern(itemName);
+            foodItems.add(item, quantity, PriceCatalog::instance().priceOf(item).value_or(0.0));
+        }
+        void generateBill() {
+            string text = "Generating bill for recent orders:\n";
+            foodItems.appendBill(text);
+            text += "Total: $";
+            OrderTable::appendPrice(text, foodItems.total());
+            text += "\nBill generated successfully!\n";
+            cout.write(text.data(), static_cast<streamsize>(text.size()));
+        }
+    };
+
+    auto residentBytes = [] {
+        ifstream statm("/proc/self/statm");
+        size_t pages = 0, resident = 0;
+        statm >> pages >> resident;
+        return resident * static_cast<size_t>(sysconf(_SC_PAGESIZE));
+    };
+
+    // Runs the rush; login(i) returns a session, logout ends it
+    struct Result {
+        double allocsPerOrder;
+        double allocsPerLogin;
+        double peakMB;
+        double loginsPerSec;
+    };
+    auto rush = [&](auto login, auto logout) {
+        using Session = decltype(login(size_t(0)));
+        for (const string &item : menu) {
+            PriceCatalog::instance().setPrice(SymbolTable::instance().intern(item), 3.0);
+        }
+        malloc_trim(0);
+        size_t before = residentBytes();
+        size_t peak = before;
+        size_t orders = 0;
+        size_t callsBefore = allocationCalls;
+        deque<Session> sessions;
+        mt19937 rng(2024);
+        NullBuffer nullBuffer;
+        streambuf *console = cout.rdbuf(&nullBuffer);
+        auto start = chrono::steady_clock::now();
+        for (size_t i = 0; i < logins; ++i) {
+            Session session = login(i);
+            int count = 1 + static_cast<int>(rng() % 20);
+            for (int o = 0; o < count; ++o) {
+                session->placeOrder(menu[rng() % menuSize], 1 + static_cast<int>(rng() % 3));
+            }
+            session->generateBill();
+            orders += static_cast<size_t>(count);
+            sessions.push_back(move(session));
+            if (sessions.size() > live) {
+                logout(move(sessions.front()));
+                sessions.pop_front();
+            }
+            if (i % 100 == 0) {
+                peak = max(peak, residentBytes());
+            }
+        }
+        while (!sessions.empty()) {
+            logout(move(sessions.front()));
+            sessions.pop_front();
+        }
+        double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+        cout.rdbuf(console);
+        double calls = static_cast<double>(allocationCalls - callsBefore);
+        return Result{calls / orders, calls / logins, (peak - before) / 1048576.0, logins / seconds};
+    };
+
+    const char *const names[] = {"before: new, heap orders", "new, session arena", "pooled, session arena"};
+    if (variant < 0) {
+        // Each way runs in a process of its own, so none reuses heap pages another one freed
+        cout << "Logins: " << logins << ", " << live << " logged in at a time\n";
+        if (!countingAllocations) {
+            cout << "Allocator calls are only counted in a build with -DCOUNT_ALLOCATIONS\n";
+        }
+        cout << left << setw(28) << "Sessions" << right << setw(14) << "Allocs/order" << setw(14) << "Allocs/login"
+             << setw(14) << "Peak RSS MB" << setw(12) << "Logins/s" << endl;
+        char self[4096];
+        ssize_t length = readlink("/proc/self/exe", self, sizeof(self));
+        for (int v = 0; v < 3 && length > 0; ++v) {
+            string command = "'" + string(self, static_cast<size_t>(length)) + "' --bench churn " +
+                             to_string(logins) + " " + to_string(v);
+            if (system(command.c_str()) != 0) {
+                cout << names[v] << ": run failed\n";
+            }
+        }
+        return;
+    }
+
+    Result r;
+    if (variant == 0) {
+        r = rush([](size_t i) { return unique_ptr<HeapSession>(new HeapSession{"emp" + to_string(i), int(i), "emp123"}); },
+                 [](unique_ptr<HeapSession>) {});
+    } else if (variant == 1) {
+        r = rush([](size_t i) { return unique_ptr<Employee>(new Employee("emp" + to_string(i), int(i), "emp123")); },
+                 [](unique_ptr<Employee>) {});
+    } else {
+        r = rush([](size_t i) { return PersonPool::instance().employee("emp" + to_string(i), int(i), "emp123"); },
+                 [](Employee *employee) { PersonPool::instance().release(employee); });
+    }
+    cout << left << setw(28) << names[min(variant, 2)] << right << fixed << setprecision(2);
+    if (countingAllocations) {
+        cout << setw(14) << r.allocsPerOrder << setw(14) << r.allocsPerLogin;
+    } else {
+        cout << setw(14) << "-" << setw(14) << "-";
+    }
+    cout << setw(14) << r.peakMB << setprecision(0) << setw(12) << r.loginsPerSec << "\n";
+    cout.unsetf(ios::floatfield);
+}
+
 // Main function
-int main() {
+int main(int argc, char *argv[]) {
+    // Benchmarks: ./test --bench [ops [records] | bill [lines] | churn [logins]]
+    if (argc > 1 && string(argv[1]) == "--bench") {
+        string which = argc > 2 ? argv[2] : "all";
+        if (which == "ops" || which == "all") {
+            benchOperations(argc > 3 ? stoul(argv[3]) : 1000);
+        }
+        if (which == "bill" || which == "all") {
+            benchBill(argc > 3 ? stoul(argv[3]) : 1000000);
+        }
+        if (which == "churn" || which == "all") {
+            benchChurn(argc > 3 ? stoul(argv[3]) : 10000, argc > 4 ? stoi(argv[4]) : -1);
+        }
+        return 0;
+    }
+    // Batch mode: ./test --batch [command-file | -] [--quiet]
+    if (argc > 1 && string(argv[1]) == "--batch") {
+        string file = "-";
+        bool quiet = false;
+        for (int i = 2; i < argc; ++i) {
+            if (string(argv[i]) == "--quiet") {
+                quiet = true;
+            } else {
+                file = argv[i];
+            }
+        }
+        if (file == "-") {
+            return runBatch(cin, quiet);
+        }
+        ifstream commands(file);
+        if (!commands.is_open()) {
+            cout << "Unable to open command file " << file << ".\n";
+            return 1;
+        }
+        return runBatch(commands, quiet);
+    }
+    startStatsSignalThread();
+
     Person *user = nullptr; // Pointer to hold authenticated user
     int choice;
 
@@ -342,6 +1602,8 @@ int main() {
                 if (authenticateAdmin(username, password, user)) {
                     Admin *admin = dynamic_cast<Admin *>(user); // Cast to Admin
                     admin->displayMenu(); // Show Admin menu
+                    PersonPool::instance().release(user); // Kept for the next login
+                    user = nullptr;
                 }
                 break;
             }
@@ -359,6 +1621,8 @@ int main() {
                 if (authenticateEmployee(username, id, password, user, adminRef)) {
                     Employee *employee = dynamic_cast<Employee *>(user); // Cast to Employee
                     employee->displayMenu(); // Show Employee menu
+                    PersonPool::instance().release(user); // Kept for the next login
+                    user = nullptr;
                 }
                 break;
             }
@@ -371,8 +1635,5 @@ int main() {
             }
         }
     } while (choice != 3);
-
-    // Cleanup
-    delete user; // Delete dynamically allocated user
     return 0;
 }
@@ -4,25 +4,44 @@
 #include <vector>
 #include <iomanip>
 #include <algorithm> // For case-insensitive string comparison
+#include <charconv>
+#include <string_view>
+#include <unordered_map>
+#include <chrono>
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <thread>
+#include <map>
+#include <functional>
+#include <type_traits>
+#include <memory_resource>
+#include <ctime>
+#include <cerrno>
+#include <cstdlib>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/file.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <cstring>
+#include <cmath>
+#include <climits>
+#include <sstream>
+#include <deque>
+#include <csignal>
+#include <pthread.h>
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#endif
 
 using namespace std;
 
-// Base class Person
-class Person {
-protected:
-    string name;
-    int id;
-    string password;
-
+// Employee records with O(1) lookup by ID and by case-folded name
+class EmployeeStore {
 public:
-    Person(string n, int i, string pass) : name(n), id(i), password(pass) {}
-    Person(string n, string pass) : name(n), password(pass) {}  // Corrected constructor for Admin
-    virtual void displayMenu() = 0; // Pure virtual function
-};
-
-// Derived class Admin
-class Admin : public Person {
-private:
     struct EmployeeData {
         string name;
         int age;
@@ -30,375 +49,5178 @@ private:
         double salary;
     };
 
-    struct InventoryItem {
-        string itemName;
-        int quantity;
-        double price;
-    };
+    // Lower-cases a name so that name lookups are case-insensitive
+    static string foldCase(const string &s) {
+        string folded(s);
+        for (char &c : folded) {
+            c = static_cast<char>(tolower(static_cast<unsigned char>(c)));
+        }
+        return folded;
+    }
 
-    vector<EmployeeData> employeeData;
+    EmployeeData *findByID(int empID) {
+        auto it = byID.find(empID);
+        return it == byID.end() ? nullptr : &records[it->second];
+    }
 
-    // Helper for case-insensitive string comparison
-    bool caseInsensitiveMatch(const string &a, const string &b) {
-        return equal(a.begin(), a.end(), b.begin(), b.end(),
-                     [](char a, char b) { return tolower(a) == tolower(b); });
+    EmployeeData *findByName(const string &name) {
+        auto it = byName.find(foldCase(name));
+        return it == byName.end() ? nullptr : &records[it->second];
     }
 
-    // Helper function to write inventory to file
-    void writeToFile(const InventoryItem &item) {
-        ofstream outFile("inv.csv", ios::app); // Open in append mode
-        if (outFile.is_open()) {
-            outFile << item.itemName << "," << item.quantity << "," << item.price << endl;
-            outFile.close();
-        } else {
-            cout << "Unable to open inventory file for writing.\n";
+    // Returns false if the name or the ID is already taken
+    bool insert(const EmployeeData &emp) {
+        string key = foldCase(emp.name);
+        if (byName.count(key) || byID.count(emp.empID)) {
+            return false;
         }
+        byID.emplace(emp.empID, records.size());
+        byName.emplace(move(key), records.size());
+        records.push_back(emp);
+        return true;
     }
 
-    // Helper function to read inventory from file
-    vector<InventoryItem> readFromFile() {
-        vector<InventoryItem> inventory;
-        ifstream inFile("inv.csv");
-        if (inFile.is_open()) {
-            string line;
-            while (getline(inFile, line)) {
-                size_t pos1 = line.find(",");
-                size_t pos2 = line.find(",", pos1 + 1);
+    // Returns false if another employee already has the new name
+    bool rename(int empID, const string &newName) {
+        auto it = byID.find(empID);
+        if (it == byID.end()) {
+            return false;
+        }
+        string oldKey = foldCase(records[it->second].name);
+        string newKey = foldCase(newName);
+        if (newKey != oldKey) {
+            if (byName.count(newKey)) {
+                return false;
+            }
+            byName.erase(oldKey);
+            byName.emplace(move(newKey), it->second);
+        }
+        records[it->second].name = newName;
+        return true;
+    }
 
-                if (pos1 == string::npos || pos2 == string::npos) {
-                    continue; // Skip malformed lines
-                }
+    bool eraseByID(int empID) {
+        auto it = byID.find(empID);
+        if (it == byID.end()) {
+            return false;
+        }
+        eraseSlot(it->second);
+        return true;
+    }
 
-                string itemName = line.substr(0, pos1);
-                int quantity = stoi(line.substr(pos1 + 1, pos2 - pos1 - 1));
-                double price = stod(line.substr(pos2 + 1));
+    bool eraseByName(const string &name) {
+        auto it = byName.find(foldCase(name));
+        if (it == byName.end()) {
+            return false;
+        }
+        eraseSlot(it->second);
+        return true;
+    }
 
-                inventory.push_back({itemName, quantity, price});
-            }
+    void reserve(size_t n) {
+        records.reserve(n);
+        byID.reserve(n);
+        byName.reserve(n);
+    }
 
-            inFile.close();
-        } else {
-            cout << "Unable to open inventory file for reading.\n";
-        }
+    size_t size() const { return records.size(); }
+    bool empty() const { return records.empty(); }
+    vector<EmployeeData>::const_iterator begin() const { return records.begin(); }
+    vector<EmployeeData>::const_iterator end() const { return records.end(); }
 
-        return inventory;
+private:
+    vector<EmployeeData> records;
+    unordered_map<int, size_t> byID;      // empID -> slot in records
+    unordered_map<string, size_t> byName; // folded name -> slot in records
+
+    // Swap-remove: move the last record into the freed slot so nothing shifts
+    void eraseSlot(size_t slot) {
+        byID.erase(records[slot].empID);
+        byName.erase(foldCase(records[slot].name));
+        size_t last = records.size() - 1;
+        if (slot != last) {
+            records[slot] = move(records[last]);
+            byID[records[slot].empID] = slot;
+            byName[foldCase(records[slot].name)] = slot;
+        }
+        records.pop_back();
     }
+};
 
-    // Write employee data to file
-    void writeEmployeeToFile(const EmployeeData &emp) {
-        ofstream outFile("employee_details.csv", ios::app);
-        if (outFile.is_open()) {
-            outFile << emp.name << "," << emp.age << "," << emp.empID << "," << emp.salary << endl;
-            outFile.close();
-        } else {
-            cout << "Unable to open employee details file for writing.\n";
+// Holds an exclusive flock for the lifetime of the object
+struct FileLock {
+    int fd;
+    explicit FileLock(int f) : fd(f) {
+        if (fd >= 0) {
+            flock(fd, LOCK_EX);
+        }
+    }
+    ~FileLock() {
+        if (fd >= 0) {
+            flock(fd, LOCK_UN);
         }
     }
+};
 
+// Absolute form of a data file path. The process-wide stores keep their files
+// by absolute path, so a later chdir (as the ops benchmark makes into its
+// scratch directory and back) never points them at another directory's files.
+inline string anchoredPath(const string &path) { return filesystem::absolute(path).string(); }
+
+// Employee records kept in a file of fixed-size slots (employees.dat) and
+// loaded once at startup. Adding an employee appends a slot, an edit rewrites
+// its slot in place and a delete marks the slot as a tombstone, so each costs
+// one small write however many employees there are. Once tombstones outnumber
+// live slots, a background thread copies the live slots to a new file and
+// swaps it in.
+//
+// Several processes may share the file. Every change is made under an flock
+// on employees.dat.lock, which also holds a change counter: a process that
+// finds the counter moved rereads the file before touching it, which also
+// picks up a file swapped in by another process's compaction.
+//
+//   Header  magic "CANTEMP1", version, slot size
+//   Slot    state, employee ID, age, name length, salary, name
+class EmployeeRegistry {
 public:
-    Admin(string n, string pass) : Person(n, pass) {}
+    using EmployeeData = EmployeeStore::EmployeeData;
+    static constexpr size_t maxNameBytes = 40;
 
-    void addEmployee() {
-        EmployeeData newEmp;
-        cout << "Enter Employee Name: ";
-        cin >> newEmp.name;
+    static EmployeeRegistry &instance() {
+        static EmployeeRegistry registry(anchoredPath("employees.dat"), anchoredPath("employee_details.csv"));
+        return registry;
+    }
 
-        // Check if the name already exists
-        for (const auto &emp : employeeData) {
-            if (caseInsensitiveMatch(emp.name, newEmp.name)) {
-                cout << "Employee with this name already exists. Please enter a different name.\n";
-                return;
+    // legacyCsv, if given, is imported when this call creates the file
+    explicit EmployeeRegistry(string path, const string &legacyCsv = "", size_t compactMinTombstones = 64)
+        : path(move(path)), compactMinTombstones(compactMinTombstones) {
+        lockFd = ::open((this->path + ".lock").c_str(), O_RDWR | O_CREAT, 0644);
+        if (lockFd < 0) {
+            cout << "Unable to open " << this->path << ".lock.\n";
+            return;
+        }
+        FileLock fileLock(lockFd);
+        generation = readGeneration();
+        fd = ::open(this->path.c_str(), O_RDWR | O_CREAT, 0644);
+        struct stat info;
+        if (fd < 0 || fstat(fd, &info) != 0) {
+            cout << "Unable to open " << this->path << ".\n";
+            closeFile();
+            return;
+        }
+        if (info.st_size == 0) {
+            const Header header = newHeader();
+            if (::pwrite(fd, &header, sizeof(header), 0) != static_cast<ssize_t>(sizeof(header))) {
+                cout << "Unable to write " << this->path << ".\n";
+                closeFile();
+            } else if (!legacyCsv.empty()) {
+                importCsv(legacyCsv); // Under the file lock, so no other process sees it half done
             }
+            return;
         }
+        loadSlots(static_cast<size_t>(info.st_size));
+    }
 
-        // Age validation
-        do {
-            cout << "Enter Employee Age (should not exceed 85): ";
-            cin >> newEmp.age;
-            if (newEmp.age > 85) {
-                cout << "Invalid age. Age cannot be greater than 85. Please re-enter.\n";
-            }
-        } while (newEmp.age > 85);
+    ~EmployeeRegistry() {
+        if (compactor.joinable()) {
+            compactor.join();
+        }
+        closeFile();
+        if (lockFd >= 0) {
+            ::close(lockFd);
+        }
+    }
 
-        cout << "Enter Employee ID: ";
-        cin >> newEmp.empID;
+    EmployeeRegistry(const EmployeeRegistry &) = delete;
+    EmployeeRegistry &operator=(const EmployeeRegistry &) = delete;
 
-        // Check if the ID already exists
-        for (const auto &emp : employeeData) {
-            if (emp.empID == newEmp.empID) {
-                cout << "Employee with this ID already exists. Please enter a different ID.\n";
-                return;
+    bool isOpen() const { return fd >= 0; }
+
+    // Live employees in file order
+    vector<EmployeeData> employees() {
+        lock_guard<mutex> lock(mtx);
+        FileLock fileLock(lockFd);
+        catchUp();
+        vector<EmployeeData> live;
+        live.reserve(slotByID.size());
+        for (const auto &slot : slots) {
+            if (slot.state == slotLive) {
+                live.push_back({string(slot.name, slot.nameLength), slot.age, slot.empID, slot.salary});
             }
         }
+        return live;
+    }
 
-        cout << "Enter Employee Salary: ";
-        cin >> newEmp.salary;
-
-        employeeData.push_back(newEmp);
-
-        // Write to employee_details.csv
-        writeEmployeeToFile(newEmp);
+    // Adds emp, or rewrites its slot in place if the ID is already registered.
+    // Returns false if the name is longer than maxNameBytes or the write failed.
+    bool put(const EmployeeData &emp) {
+        if (emp.name.size() > maxNameBytes) {
+            return false;
+        }
+        lock_guard<mutex> lock(mtx);
+        FileLock fileLock(lockFd);
+        catchUp();
+        if (!writeSlot(emp)) {
+            return false;
+        }
+        publishChange();
+        return true;
+    }
 
-        cout << "Employee added successfully!\n";
+    // Marks the employee's slot as a tombstone; false if the ID is unknown or the write failed
+    bool remove(int empID) {
+        lock_guard<mutex> lock(mtx);
+        FileLock fileLock(lockFd);
+        catchUp();
+        auto found = slotByID.find(empID);
+        if (found == slotByID.end()) {
+            return false;
+        }
+        const uint32_t state = slotDeleted;
+        if (!writeAt(offsetOf(found->second), &state, sizeof(state))) {
+            return false;
+        }
+        slots[found->second].state = slotDeleted;
+        slotByID.erase(found);
+        ++tombstones;
+        publishChange();
+        if (tombstones >= compactMinTombstones && tombstones > slotByID.size() && !compacting) {
+            compacting = true;
+            if (compactor.joinable()) {
+                compactor.join(); // Finished: compacting is cleared only at its end
+            }
+            compactor = thread([this] {
+                compact();
+                lock_guard<mutex> lock(mtx);
+                compacting = false;
+            });
+        }
+        return true;
     }
 
-    void deleteEmployee() {
-        int choice;
-        cout << "Delete Employee by:\n1. Name\n2. ID\nEnter choice: ";
-        cin >> choice;
+    size_t size() {
+        lock_guard<mutex> lock(mtx);
+        FileLock fileLock(lockFd);
+        catchUp();
+        return slotByID.size();
+    }
 
-        string empName;
-        int empID;
-        bool found = false;
+    size_t tombstoneCount() {
+        lock_guard<mutex> lock(mtx);
+        FileLock fileLock(lockFd);
+        catchUp();
+        return tombstones;
+    }
 
-        if (choice == 1) {
-            cout << "Enter Employee Name to delete: ";
-            cin >> empName;
-            for (auto it = employeeData.begin(); it != employeeData.end(); ++it) {
-                if (caseInsensitiveMatch(it->name, empName)) {
-                    employeeData.erase(it);
-                    cout << "Employee " << empName << " deleted successfully!\n";
-                    found = true;
-                    break;
-                }
-            }
-        } else if (choice == 2) {
-            cout << "Enter Employee ID to delete: ";
-            cin >> empID;
-            for (auto it = employeeData.begin(); it != employeeData.end(); ++it) {
-                if (it->empID == empID) {
-                    employeeData.erase(it);
-                    cout << "Employee with ID " << empID << " deleted successfully!\n";
-                    found = true;
-                    break;
-                }
+    // Rewrites the file without tombstones through a synced temporary file and an
+    // atomic rename. Both locks are held throughout, so no process can write to
+    // the old file after it has been copied.
+    bool compact() {
+        const string tmpPath = path + ".tmp";
+        lock_guard<mutex> lock(mtx);
+        FileLock fileLock(lockFd);
+        catchUp();
+        if (fd < 0) {
+            return false;
+        }
+        vector<Slot> live = liveSlots();
+        int newFd = writeFile(tmpPath, live);
+        if (newFd < 0 || rename(tmpPath.c_str(), path.c_str()) != 0) {
+            if (newFd >= 0) {
+                ::close(newFd);
             }
-        } else {
-            cout << "Invalid option!\n";
+            ::unlink(tmpPath.c_str());
+            return false;
+        }
+        ::close(fd);
+        fd = newFd;
+        slots = move(live);
+        slotByID.clear();
+        for (uint32_t slot = 0; slot < slots.size(); ++slot) {
+            slotByID[slots[slot].empID] = slot;
         }
+        tombstones = 0;
+        publishChange();
+        return true;
+    }
 
-        if (!found) {
-            cout << "Employee not found.\n";
+private:
+    struct Header {
+        char magic[8];
+        uint32_t version;
+        uint32_t slotSize;
+    };
+
+    struct Slot {
+        uint32_t state;
+        int32_t empID;
+        int32_t age;
+        uint32_t nameLength;
+        double salary;
+        char name[maxNameBytes];
+    };
+    static_assert(sizeof(Slot) == 64, "slots are one cache line");
+
+    static constexpr uint32_t slotLive = 1;
+    static constexpr uint32_t slotDeleted = 2;
+
+    string path;
+    size_t compactMinTombstones;
+    int fd = -1;
+    int lockFd = -1;         // employees.dat.lock: the flock and the change counter
+    uint64_t generation = 0; // Change counter as of the last read or write of the file
+    mutable mutex mtx;
+    vector<Slot> slots;                     // Copy of every slot in the file
+    unordered_map<int, uint32_t> slotByID;  // Live slots only
+    size_t tombstones = 0;
+    bool compacting = false;
+    thread compactor;
+
+    static Header newHeader() { return {{'C', 'A', 'N', 'T', 'E', 'M', 'P', '1'}, 1, sizeof(Slot)}; }
+
+    static off_t offsetOf(uint32_t slot) { return static_cast<off_t>(sizeof(Header) + size_t(slot) * sizeof(Slot)); }
+
+    void importCsv(const string &csvPath);
+
+    void closeFile() {
+        if (fd >= 0) {
+            ::close(fd);
+            fd = -1;
         }
     }
 
-    void editEmployee() {
-        int empID;
-        cout << "Enter Employee ID to edit: ";
-        cin >> empID;
+    uint64_t readGeneration() const {
+        uint64_t current = 0;
+        if (lockFd < 0 || ::pread(lockFd, &current, sizeof(current), 0) != static_cast<ssize_t>(sizeof(current))) {
+            return 0; // Nothing written yet
+        }
+        return current;
+    }
 
-        for (auto &emp : employeeData) {
-            if (emp.empID == empID) {
-                cout << "Editing Employee: " << emp.name << "\n";
-                cout << "Enter new name: ";
-                cin >> emp.name;
-                cout << "Enter new age: ";
-                cin >> emp.age;
-                cout << "Enter new salary: ";
-                cin >> emp.salary;
-                cout << "Employee details updated successfully!\n";
-                return;
-            }
+    // Tells other processes the file changed. Call with the file lock held.
+    void publishChange() {
+        ++generation;
+        if (lockFd >= 0 &&
+            ::pwrite(lockFd, &generation, sizeof(generation), 0) != static_cast<ssize_t>(sizeof(generation))) {
+            cout << "Unable to write to " << path << ".lock.\n";
         }
-        cout << "Employee not found.\n";
     }
 
-    void viewEmployees() {
-        if (employeeData.empty()) {
-            cout << "No employees to display.\n";
+    // Rereads the file if another process changed it since we last looked.
+    // Call with both locks held.
+    void catchUp() {
+        uint64_t current = readGeneration();
+        if (current == generation) {
             return;
         }
-
-        cout << "\n=============================================\n";
-        cout << setw(10) << left << "Name" << setw(10) << "Age" << setw(10) << "ID" << setw(10) << "Salary" << endl;
-        cout << "=============================================\n";
-        for (const auto &emp : employeeData) {
-            cout << setw(10) << left << emp.name
-                 << setw(10) << emp.age
-                 << setw(10) << emp.empID
-                 << "$" << setw(9) << emp.salary << endl;
+        generation = current;
+        closeFile();
+        slots.clear();
+        slotByID.clear();
+        tombstones = 0;
+        fd = ::open(path.c_str(), O_RDWR);
+        struct stat info;
+        if (fd < 0 || fstat(fd, &info) != 0) {
+            cout << "Unable to open " << path << ".\n";
+            closeFile();
+            return;
         }
-        cout << "=============================================\n";
+        loadSlots(static_cast<size_t>(info.st_size));
     }
 
-    void addItemToInventory() {
-        InventoryItem newItem;
-        cout << "Enter item name: ";
-        cin >> newItem.itemName;
-        cout << "Enter quantity: ";
-        cin >> newItem.quantity;
-        cout << "Enter price: ";
-        cin >> newItem.price;
+    // Reads every slot of the open file; closes it if it is not a registry
+    void loadSlots(size_t fileSize) {
+        Header header;
+        if (::pread(fd, &header, sizeof(header), 0) != static_cast<ssize_t>(sizeof(header)) ||
+            memcmp(header.magic, newHeader().magic, sizeof(header.magic)) != 0 || header.slotSize != sizeof(Slot)) {
+            cout << path << " is not an employee registry; leaving it untouched.\n";
+            closeFile();
+            return;
+        }
+        // A slot cut short by a crash is overwritten by the next add
+        slots.resize((fileSize - sizeof(Header)) / sizeof(Slot));
+        size_t bytes = slots.size() * sizeof(Slot);
+        if (bytes > 0 && ::pread(fd, slots.data(), bytes, sizeof(Header)) != static_cast<ssize_t>(bytes)) {
+            cout << "Unable to read " << path << ".\n";
+            slots.clear();
+            closeFile();
+            return;
+        }
+        size_t damaged = 0;
+        for (uint32_t slot = 0; slot < slots.size(); ++slot) {
+            if (slots[slot].state == slotLive && slots[slot].nameLength > maxNameBytes) {
+                slots[slot].state = slotDeleted; // Dropped by the next compaction
+                ++damaged;
+            }
+            if (slots[slot].state != slotLive) {
+                ++tombstones;
+                continue;
+            }
+            auto found = slotByID.find(slots[slot].empID);
+            if (found != slotByID.end()) {
+                slots[found->second].state = slotDeleted; // An ID written twice: the later slot wins
+                ++tombstones;
+            }
+            slotByID[slots[slot].empID] = slot;
+        }
+        if (damaged > 0) {
+            cout << "Skipped " << damaged << " damaged employee records in " << path << ".\n";
+        }
+    }
 
-        // Write the new item to the CSV file
-        writeToFile(newItem);
+    // Adds or rewrites emp's slot; call with both locks held
+    bool writeSlot(const EmployeeData &emp) {
+        Slot record{};
+        record.state = slotLive;
+        record.empID = emp.empID;
+        record.age = emp.age;
+        record.nameLength = static_cast<uint32_t>(emp.name.size());
+        record.salary = emp.salary;
+        memcpy(record.name, emp.name.data(), emp.name.size());
 
-        cout << "Item added to inventory successfully!\n";
+        auto found = slotByID.find(emp.empID);
+        uint32_t slot = found != slotByID.end() ? found->second : static_cast<uint32_t>(slots.size());
+        if (!writeAt(offsetOf(slot), &record, sizeof(record))) {
+            return false;
+        }
+        if (slot == slots.size()) {
+            slots.push_back(record);
+            slotByID.emplace(emp.empID, slot);
+        } else {
+            slots[slot] = record;
+        }
+        return true;
     }
 
-    void viewInventory() {
-        vector<InventoryItem> inventory = readFromFile();
+    bool writeAt(off_t offset, const void *data, size_t size) {
+        if (fd < 0 || ::pwrite(fd, data, size, offset) != static_cast<ssize_t>(size)) {
+            cout << "Unable to write to " << path << ".\n";
+            return false;
+        }
+        return true;
+    }
 
-        if (!inventory.empty()) {
-            cout << "\n=============================================\n";
-            cout << setw(15) << left << "Item Name" << setw(10) << "Quantity" << setw(10) << "Price" << endl;
-            cout << "=============================================\n";
-            for (const auto &item : inventory) {
-                cout << setw(15) << left << item.itemName
-                     << setw(10) << item.quantity
-                     << "$" << setw(9) << item.price << endl;
+    vector<Slot> liveSlots() const {
+        vector<Slot> live;
+        live.reserve(slotByID.size());
+        for (const auto &slot : slots) {
+            if (slot.state == slotLive) {
+                live.push_back(slot);
             }
-            cout << "=============================================\n";
-        } else {
-            cout << "Inventory is empty.\n";
         }
+        return live;
     }
 
-    void displayMenu() override {
-        int choice;
-        do {
-            cout << "\nAdmin Menu:\n1. Add Employee\n2. Delete Employee\n3. Edit Employee\n4. View Employees\n"
-                 << "5. Add Inventory Item\n6. View Inventory\n7. Logout\n";
-            cin >> choice;
-            switch (choice) {
-                case 1: addEmployee(); break;
-                case 2: deleteEmployee(); break;
-                case 3: editEmployee(); break;
-                case 4: viewEmployees(); break;
-                case 5: addItemToInventory(); break;
-                case 6: viewInventory(); break;
-                case 7: cout << "Logging out of Admin Menu.\n"; break;
-                default: cout << "Invalid option!\n";
-            }
-        } while (choice != 7);
+    // Returns the new file opened for updates, or -1
+    static int writeFile(const string &tmpPath, const vector<Slot> &live) {
+        int out = ::open(tmpPath.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+        if (out < 0) {
+            return -1;
+        }
+        const Header header = newHeader();
+        size_t bytes = live.size() * sizeof(Slot);
+        bool ok = ::pwrite(out, &header, sizeof(header), 0) == static_cast<ssize_t>(sizeof(header)) &&
+                  (bytes == 0 || ::pwrite(out, live.data(), bytes, sizeof(header)) == static_cast<ssize_t>(bytes)) &&
+                  fdatasync(out) == 0;
+        if (!ok) {
+            ::close(out);
+            return -1;
+        }
+        return out;
     }
 };
 
-// Derived class Employee
-class Employee : public Person {
-private:
-    struct InventoryItem {
-        string itemName;
-        int quantity;
-        double price;
+// Hot-path instrumentation: per-thread latency histograms and per-file byte
+// counters, cheap enough to leave on while serving. Stats::dump() merges all
+// threads; it is reachable from the Admin menu and by sending SIGUSR1.
+enum Probe { ProbeOrderItems, ProbeReadFromFile, ProbeWriteOrderToFile, ProbeCount };
+const char *const probeNames[ProbeCount] = {"orderItems", "readFromFile", "writeOrderToFile"};
+
+class Stats {
+public:
+    struct FileBytes {
+        string path;
+        atomic<uint64_t> read{0};
+        atomic<uint64_t> written{0};
+        explicit FileBytes(string p) : path(move(p)) {}
     };
 
-    void writeOrderToFile(const string &orderDetails) {
-        ofstream outFile("orders.csv", ios::app);
-        if (outFile.is_open()) {
-            outFile << orderDetails << endl;
-            outFile.close();
-        } else {
-            cout << "Unable to open orders file for writing.\n";
+    // Counters for one file. The reference stays valid for the life of the
+    // process, so anything that touches a file often looks it up once and keeps it.
+    static FileBytes &file(const string &path) {
+        lock_guard<mutex> lock(registryMutex());
+        for (auto &counters : files()) {
+            if (counters.path == path) {
+                return counters;
+            }
         }
+        files().emplace_back(path);
+        return files().back();
     }
 
-    // Read inventory from file
-    vector<InventoryItem> readFromFile() {
-        vector<InventoryItem> inventory;
-        ifstream inFile("inv.csv");
-        if (inFile.is_open()) {
-            string line;
-            while (getline(inFile, line)) {
-                size_t pos1 = line.find(",");
-                size_t pos2 = line.find(",", pos1 + 1);
+    static void record(Probe probe, uint64_t ns) {
+        atomic<uint64_t> &counter = local().buckets[probe][bucketOf(ns)];
+        // Only the owning thread writes its counters, so a plain load/store is enough
+        counter.store(counter.load(memory_order_relaxed) + 1, memory_order_relaxed);
+    }
 
-                if (pos1 == string::npos || pos2 == string::npos) {
-                    continue; // Skip malformed lines
-                }
+    static void addBytesRead(const string &path, uint64_t bytes) {
+        file(path).read.fetch_add(bytes, memory_order_relaxed);
+    }
+
+    static void addBytesWritten(const string &path, uint64_t bytes) {
+        file(path).written.fetch_add(bytes, memory_order_relaxed);
+    }
+
+    static void addBytesRead(FileBytes &counters, uint64_t bytes) { counters.read.fetch_add(bytes, memory_order_relaxed); }
 
-                string itemName = line.substr(0, pos1);
-                int quantity = stoi(line.substr(pos1 + 1, pos2 - pos1 - 1));
-                double price = stod(line.substr(pos2 + 1));
+    static void addBytesWritten(FileBytes &counters, uint64_t bytes) {
+        counters.written.fetch_add(bytes, memory_order_relaxed);
+    }
+
+    // What happened to records handed to the background writer (see AsyncJournal)
+    enum WriterEvent { WriterQueued, WriterBlocked, WriterDropped, WriterSpilled, WriterEventCount };
 
-                inventory.push_back({itemName, quantity, price});
+    static void countWriter(WriterEvent event) { writerEvents()[event].fetch_add(1, memory_order_relaxed); }
+
+    static void dump(ostream &out) {
+        vector<uint64_t> merged(bucketCount);
+        out << "\n" << setw(20) << left << "Operation" << setw(12) << "Count" << setw(12) << "p50 us"
+            << setw(12) << "p99 us" << setw(12) << "p999 us" << "\n";
+        for (int probe = 0; probe < ProbeCount; ++probe) {
+            fill(merged.begin(), merged.end(), 0);
+            uint64_t count = 0;
+            {
+                lock_guard<mutex> lock(registryMutex());
+                for (const auto &histograms : threads()) {
+                    for (size_t b = 0; b < bucketCount; ++b) {
+                        uint64_t n = histograms->buckets[probe][b].load(memory_order_relaxed);
+                        merged[b] += n;
+                        count += n;
+                    }
+                }
             }
+            out << fixed << setprecision(2) << setw(20) << left << probeNames[probe] << setw(12) << count
+                << setw(12) << percentile(merged, count, 0.50) / 1000.0
+                << setw(12) << percentile(merged, count, 0.99) / 1000.0
+                << setw(12) << percentile(merged, count, 0.999) / 1000.0 << "\n";
+        }
 
-            inFile.close();
-        } else {
-            cout << "Unable to open inventory file for reading.\n";
+        const atomic<uint64_t> *writer = writerEvents();
+        if (writer[WriterQueued].load() + writer[WriterDropped].load() + writer[WriterSpilled].load() > 0) {
+            out << "Background writer: " << writer[WriterQueued].load() << " queued, " << writer[WriterBlocked].load()
+                << " blocked, " << writer[WriterDropped].load() << " dropped, " << writer[WriterSpilled].load()
+                << " spilled\n";
         }
 
-        return inventory;
+        lock_guard<mutex> lock(registryMutex());
+        if (!files().empty()) {
+            out << setw(24) << left << "File" << setw(16) << "Bytes read" << setw(16) << "Bytes written" << "\n";
+            for (const auto &counters : files()) {
+                out << setw(24) << left << counters.path << setw(16) << counters.read.load()
+                    << setw(16) << counters.written.load() << "\n";
+            }
+        }
+        out.flush();
     }
 
-public:
-    Employee(string n, int i, string pass) : Person(n, i, pass) {}
+private:
+    // Log-linear buckets: exact below 16 ns, then 16 per power of two (about 6% error)
+    static constexpr size_t bucketCount = 976;
 
-    void orderItems() {
-        vector<InventoryItem> inventory = readFromFile();
+    struct ThreadHistograms {
+        atomic<uint64_t> buckets[ProbeCount][bucketCount] = {};
+    };
 
-        if (inventory.empty()) {
-            cout << "Inventory is empty.\n";
-            return;
+    static size_t bucketOf(uint64_t ns) {
+        if (ns < 16) {
+            return static_cast<size_t>(ns);
         }
+        int msb = 63 - __builtin_clzll(ns);
+        return static_cast<size_t>(msb - 3) * 16 + ((ns >> (msb - 4)) & 15);
+    }
 
-        string orderedItems;
-        double totalAmount = 0.0;
-        int itemNumber, quantity;
-
-        do {
-            cout << "\nAvailable Inventory:\n";
-            for (size_t i = 0; i < inventory.size(); ++i) {
-                cout << i + 1 << ". " << inventory[i].itemName
-                     << " (Price: $" << inventory[i].price
-                     << ", Available Quantity: " << inventory[i].quantity << ")\n";
-            }
+    // Midpoint of the bucket's value range
+    static double bucketValue(size_t bucket) {
+        if (bucket < 16) {
+            return static_cast<double>(bucket);
+        }
+        int msb = static_cast<int>(bucket / 16) + 3;
+        double low = static_cast<double>((16 + bucket % 16) << (msb - 4));
+        return low + static_cast<double>(1ULL << (msb - 4)) / 2;
+    }
 
-            cout << "Enter item number to order (0 to finish): ";
-            cin >> itemNumber;
-            if (itemNumber == 0) {
-                break;
+    static double percentile(const vector<uint64_t> &buckets, uint64_t count, double fraction) {
+        if (count == 0) {
+            return 0.0;
+        }
+        uint64_t rank = static_cast<uint64_t>(fraction * (count - 1)) + 1;
+        uint64_t seen = 0;
+        for (size_t b = 0; b < buckets.size(); ++b) {
+            seen += buckets[b];
+            if (seen >= rank) {
+                return bucketValue(b);
             }
+        }
+        return bucketValue(buckets.size() - 1);
+    }
 
-            if (itemNumber > 0 && itemNumber <= static_cast<int>(inventory.size())) {
-                cout << "Enter quantity: ";
-                cin >> quantity;
+    // The registries are never destroyed: writers flushed by static destructors
+    // at exit still count their bytes, whatever order those destructors run in.
+    static mutex &registryMutex() {
+        static mutex *registry = new mutex;
+        return *registry;
+    }
 
-                InventoryItem &selectedItem = inventory[itemNumber - 1];
+    // Histograms of every thread that has recorded anything; kept after the thread exits
+    static vector<unique_ptr<ThreadHistograms>> &threads() {
+        static auto *all = new vector<unique_ptr<ThreadHistograms>>;
+        return *all;
+    }
 
-                if (quantity <= selectedItem.quantity) {
-                    selectedItem.quantity -= quantity;
-                    double itemTotal = quantity * selectedItem.price;
-                    totalAmount += itemTotal;
-                    orderedItems += selectedItem.itemName + " (x" + to_string(quantity) + "), ";
-                } else {
-                    cout << "Insufficient stock. Please try again.\n";
-                }
-            } else {
-                cout << "Invalid item number. Please try again.\n";
-            }
-        } while (itemNumber != 0);
+    static atomic<uint64_t> *writerEvents() {
+        static atomic<uint64_t> events[WriterEventCount] = {};
+        return events;
+    }
 
-        if (!orderedItems.empty()) {
-            orderedItems.pop_back(); // Remove trailing comma
-            orderedItems.pop_back();
-            string orderDetails = "Employee ID: " + to_string(id) + ", Items Ordered: " + orderedItems + ", Total Amount: $" + to_string(totalAmount);
-            writeOrderToFile(orderDetails);
+    static deque<FileBytes> &files() {
+        static auto *all = new deque<FileBytes>;
+        return *all;
+    }
 
-            cout << "Order placed successfully!\n";
-            cout << "Items Ordered: " << orderedItems << endl;
-            cout << "Total Amount: $" << totalAmount << endl;
-        } else {
-            cout << "No items were ordered.\n";
+    static ThreadHistograms &local() {
+        thread_local ThreadHistograms *mine = nullptr;
+        if (mine == nullptr) {
+            lock_guard<mutex> lock(registryMutex());
+            threads().emplace_back(new ThreadHistograms());
+            mine = threads().back().get();
         }
+        return *mine;
     }
 
-    void displayMenu() override {
-        int choice;
-        do {
-            cout << "\nEmployee Menu:\n1. Order Items\n2. Logout\n";
-            cin >> choice;
-            switch (choice) {
-                case 1: orderItems(); break;
-                case 2: cout << "Logging out of Employee Menu.\n"; break;
-                default: cout << "Invalid option!\n";
+};
+
+// Records how long the enclosing scope took under a probe
+class ScopedLatency {
+public:
+    explicit ScopedLatency(Probe probe) : probe(probe), start(chrono::steady_clock::now()) {}
+    ~ScopedLatency() {
+        auto ns = chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now() - start).count();
+        Stats::record(probe, static_cast<uint64_t>(ns));
+    }
+
+private:
+    Probe probe;
+    chrono::steady_clock::time_point start;
+};
+
+// Prints the stats to stderr on every SIGUSR1 without interrupting service.
+// Call before starting any other thread so they all inherit the blocked signal.
+void startStatsSignalThread() {
+    sigset_t signals;
+    sigemptyset(&signals);
+    sigaddset(&signals, SIGUSR1);
+    pthread_sigmask(SIG_BLOCK, &signals, nullptr);
+    thread([signals] {
+        int signal;
+        while (sigwait(&signals, &signal) == 0) {
+            Stats::dump(cerr);
+        }
+    }).detach();
+}
+
+struct InventoryItem {
+    string itemName;
+    int quantity;
+    double price;
+};
+
+// Reads a whole CSV file into one buffer and splits it into string_view fields.
+// Rows and fields point into the buffer, so parsing allocates nothing per row.
+// Malformed rows are recorded with their line number instead of throwing.
+class CsvReader {
+public:
+    struct ParseError {
+        size_t line;
+        string reason;
+    };
+
+    explicit CsvReader(const string &path) {
+        ifstream inFile(path, ios::binary | ios::ate);
+        if (!inFile.is_open()) {
+            return;
+        }
+        // A directory opens too, and seeking to its end gives a bogus size
+        struct stat info;
+        streamoff size = inFile.tellg();
+        if (size < 0 || stat(path.c_str(), &info) != 0 || !S_ISREG(info.st_mode)) {
+            return; // No size to read up to, so treated like a file that is not there
+        }
+        opened = true;
+        buffer.resize(static_cast<size_t>(size));
+        inFile.seekg(0);
+        inFile.read(&buffer[0], static_cast<streamsize>(buffer.size()));
+        buffer.resize(static_cast<size_t>(inFile.gcount())); // Shorter if the file shrank since
+        rest = buffer;
+        Stats::addBytesRead(path, buffer.size());
+    }
+
+    // Parses text already in memory; line numbers start after firstLine
+    static CsvReader fromBuffer(string text, size_t firstLine = 0) {
+        CsvReader reader;
+        reader.buffer = move(text);
+        reader.rest = reader.buffer;
+        reader.lineNumber = firstLine;
+        reader.opened = true;
+        return reader;
+    }
+
+    // Parses text the caller keeps alive, such as part of a mapped file, without copying it
+    static CsvReader overText(string_view text, size_t firstLine = 0) {
+        CsvReader reader;
+        reader.rest = text;
+        reader.borrowed = true;
+        reader.lineNumber = firstLine;
+        reader.opened = true;
+        return reader;
+    }
+
+    CsvReader(CsvReader &&other) noexcept { *this = move(other); }
+
+    CsvReader &operator=(CsvReader &&other) noexcept {
+        borrowed = other.borrowed;
+        if (borrowed) {
+            rest = other.rest;
+        } else {
+            size_t offset = static_cast<size_t>(other.rest.data() - other.buffer.data());
+            buffer = move(other.buffer);
+            rest = string_view(buffer).substr(min(offset, buffer.size()));
+        }
+        lineNumber = other.lineNumber;
+        opened = other.opened;
+        errors = move(other.errors);
+        return *this;
+    }
+
+    bool isOpen() const { return opened; }
+
+    // Splits the next non-empty line into fields; returns false at end of file
+    bool nextRow(vector<string_view> &fields) {
+        while (!rest.empty()) {
+            size_t eol = rest.find('\n');
+            string_view line = rest.substr(0, eol);
+            rest.remove_prefix(eol == string_view::npos ? rest.size() : eol + 1);
+            ++lineNumber;
+            if (!line.empty() && line.back() == '\r') {
+                line.remove_suffix(1);
             }
-        } while (choice != 2);
+            if (line.empty()) {
+                continue;
+            }
+
+            fields.clear();
+            size_t start = 0;
+            for (size_t comma; (comma = line.find(',', start)) != string_view::npos; start = comma + 1) {
+                fields.push_back(line.substr(start, comma - start));
+            }
+            fields.push_back(line.substr(start));
+            return true;
+        }
+        return false;
+    }
+
+    // Records a problem with the row last returned by nextRow()
+    void malformed(const string &reason) { errors.push_back({lineNumber, reason}); }
+
+    const vector<ParseError> &getErrors() const { return errors; }
+
+    template <typename Int>
+    static bool parseInt(string_view field, Int &value) {
+        auto result = from_chars(field.data(), field.data() + field.size(), value);
+        return result.ec == errc() && result.ptr == field.data() + field.size();
+    }
+
+    static bool parseDouble(string_view field, double &value) {
+        auto result = from_chars(field.data(), field.data() + field.size(), value);
+        return result.ec == errc() && result.ptr == field.data() + field.size();
+    }
+
+private:
+    string buffer;
+    string_view rest;
+    bool borrowed = false; // rest points at the caller's text, not buffer
+
+    CsvReader() = default;
+    size_t lineNumber = 0;
+    bool opened = false;
+    vector<ParseError> errors;
+};
+
+// Prints the malformed rows a CsvReader skipped
+void reportCsvErrors(const string &path, const vector<CsvReader::ParseError> &errors) {
+    for (const auto &error : errors) {
+        cout << "Skipping malformed line " << error.line << " in " << path << ": " << error.reason << "\n";
+    }
+}
+
+void reportCsvErrors(const string &path, const CsvReader &reader) { reportCsvErrors(path, reader.getErrors()); }
+
+// Parses inv.csv rows of the form name,quantity,price.
+// A "#checkpoint,<lsn>" row written by InventoryStore is returned through checkpoint.
+vector<InventoryItem> loadInventoryCsv(const string &path, bool report = true, uint64_t *checkpoint = nullptr) {
+    ScopedLatency latency(ProbeReadFromFile);
+    vector<InventoryItem> inventory;
+    CsvReader reader(path);
+    if (!reader.isOpen()) {
+        if (report) {
+            cout << "Unable to open inventory file for reading.\n";
+        }
+        return inventory;
+    }
+
+    vector<string_view> fields;
+    while (reader.nextRow(fields)) {
+        InventoryItem item;
+        if (fields[0] == "#checkpoint") {
+            uint64_t lsn = 0;
+            if (fields.size() != 2 || !CsvReader::parseInt(fields[1], lsn)) {
+                reader.malformed("bad checkpoint");
+            } else if (checkpoint != nullptr) {
+                *checkpoint = lsn;
+            }
+        } else if (fields.size() != 3) {
+            reader.malformed("expected 3 fields");
+        } else if (!CsvReader::parseInt(fields[1], item.quantity)) {
+            reader.malformed("bad quantity");
+        } else if (!CsvReader::parseDouble(fields[2], item.price)) {
+            reader.malformed("bad price");
+        } else {
+            item.itemName.assign(fields[0]);
+            inventory.push_back(move(item));
+        }
+    }
+    if (report) {
+        reportCsvErrors(path, reader);
+    }
+    return inventory;
+}
+
+// Long-lived append-only writer for one CSV file.
+// Records are collected in a buffer and written out as one batch when the
+// buffer or the batch age passes its threshold, or on commit(). A timer
+// thread shared by every writer checks the age too, so a batch is written
+// out on time even when no further record arrives.
+class JournalWriter {
+public:
+    enum class Durability {
+        None,     // commit() leaves records buffered until a threshold is hit
+        Flush,    // commit() writes the batch to the OS
+        Fdatasync // commit() writes the batch and waits for it to reach the disk
+    };
+
+    // One writer per file, shared by every caller in the process
+    static JournalWriter &forFile(const string &path) {
+        static mutex registryMtx;
+        static map<string, unique_ptr<JournalWriter>> writers;
+        string file = anchoredPath(path); // One writer per file, however the path is spelled
+        lock_guard<mutex> lock(registryMtx);
+        unique_ptr<JournalWriter> &writer = writers[file];
+        if (!writer) {
+            writer.reset(new JournalWriter(file, defaultDurability()));
+        }
+        return *writer;
+    }
+
+    // CANTEEN_DURABILITY=none|flush|fdatasync, flush if unset
+    static Durability defaultDurability() {
+        const char *mode = getenv("CANTEEN_DURABILITY");
+        if (mode != nullptr && string(mode) == "none") {
+            return Durability::None;
+        }
+        if (mode != nullptr && string(mode) == "fdatasync") {
+            return Durability::Fdatasync;
+        }
+        return Durability::Flush;
+    }
+
+    JournalWriter(const string &path, Durability durability, size_t maxBatchBytes = 64 * 1024,
+                  chrono::milliseconds maxBatchAge = chrono::milliseconds(200))
+        : path(path), fileBytes(Stats::file(path)), durability(durability), maxBatchBytes(maxBatchBytes),
+          maxBatchAge(maxBatchAge) {
+        fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_APPEND, 0644);
+        buffer.reserve(maxBatchBytes);
+        TimedWriters &timed = timedWriters();
+        lock_guard<mutex> lock(timed.mtx);
+        timed.writers.push_back(this);
+        if (!timed.timerStarted) {
+            timed.timerStarted = true;
+            thread(runBatchTimer).detach();
+        }
+    }
+
+    ~JournalWriter() {
+        {
+            TimedWriters &timed = timedWriters();
+            lock_guard<mutex> lock(timed.mtx); // Waits for a timer pass that may be writing this batch
+            timed.writers.erase(find(timed.writers.begin(), timed.writers.end(), this));
+        }
+        lock_guard<mutex> lock(mtx);
+        writeBatch(durability == Durability::Fdatasync);
+        if (fd >= 0) {
+            ::close(fd);
+        }
+    }
+
+    JournalWriter(const JournalWriter &) = delete;
+    JournalWriter &operator=(const JournalWriter &) = delete;
+
+    bool isOpen() const { return fd >= 0; }
+
+    void setDurability(Durability mode) {
+        lock_guard<mutex> lock(mtx);
+        durability = mode;
+    }
+
+    // Buffers one comma-separated record
+    template <typename... Fields>
+    void append(const Fields &...fields) {
+        lock_guard<mutex> lock(mtx);
+        if (buffer.empty()) {
+            batchStart = chrono::steady_clock::now();
+        }
+        bool first = true;
+        ((appendField(buffer, fields, first), first = false), ...);
+        buffer += '\n';
+        if (buffer.size() >= maxBatchBytes || chrono::steady_clock::now() - batchStart >= maxBatchAge) {
+            writeBatch(durability == Durability::Fdatasync);
+        }
+    }
+
+    // Formats one comma-separated record without appending it, for callers that write later
+    template <typename... Fields>
+    static string format(const Fields &...fields) {
+        string record;
+        bool first = true;
+        ((appendField(record, fields, first), first = false), ...);
+        return record;
+    }
+
+    // Ends a logical record; how far it is pushed depends on the durability mode
+    bool commit() {
+        bool ok;
+        size_t written;
+        {
+            lock_guard<mutex> lock(mtx);
+            if (durability == Durability::None) {
+                return true;
+            }
+            written = bytesWritten;
+            ok = writeBatch(durability == Durability::Fdatasync);
+            written = bytesWritten - written;
+        }
+        if (written > 0) {
+            notifyCommit();
+        }
+        return ok;
+    }
+
+    // Writes out anything buffered regardless of the durability mode
+    bool flush() {
+        bool ok;
+        {
+            lock_guard<mutex> lock(mtx);
+            ok = writeBatch(durability == Durability::Fdatasync);
+        }
+        notifyCommit();
+        return ok;
+    }
+
+    // Called after commit() writes records out and after every flush(), outside the
+    // writer's lock. Clearing it waits for a call in progress to return.
+    void setCommitListener(function<void()> listener) {
+        lock_guard<mutex> lock(listenerMtx);
+        commitListener = move(listener);
+    }
+
+    size_t getBytesWritten() const { return bytesWritten; }
+
+private:
+    string path;
+    Stats::FileBytes &fileBytes;
+    int fd = -1;
+    mutex mtx;
+    string buffer;
+    Durability durability;
+    size_t maxBatchBytes;
+    chrono::milliseconds maxBatchAge;
+    chrono::steady_clock::time_point batchStart;
+    size_t bytesWritten = 0;
+    mutex listenerMtx; // Held while the listener runs
+    function<void()> commitListener;
+
+    static constexpr chrono::milliseconds batchTimerInterval{50};
+
+    // Every live writer, for the batch timer. Never destroyed, because the
+    // detached timer thread may still be running while writers close at exit.
+    struct TimedWriters {
+        mutex mtx;
+        vector<JournalWriter *> writers;
+        bool timerStarted = false;
+    };
+
+    static TimedWriters &timedWriters() {
+        static auto *timed = new TimedWriters;
+        return *timed;
+    }
+
+    static void runBatchTimer() {
+        TimedWriters &timed = timedWriters();
+        for (;;) {
+            this_thread::sleep_for(batchTimerInterval);
+            lock_guard<mutex> lock(timed.mtx);
+            auto now = chrono::steady_clock::now();
+            for (JournalWriter *writer : timed.writers) {
+                writer->writeIfStale(now);
+            }
+        }
+    }
+
+    // Writes out a batch that has waited longer than maxBatchAge
+    void writeIfStale(chrono::steady_clock::time_point now) {
+        lock_guard<mutex> lock(mtx);
+        if (!buffer.empty() && now - batchStart >= maxBatchAge) {
+            writeBatch(durability == Durability::Fdatasync);
+        }
+    }
+
+    void notifyCommit() {
+        lock_guard<mutex> lock(listenerMtx);
+        if (commitListener) {
+            commitListener();
+        }
+    }
+
+    static void appendField(string &out, string_view field, bool first) {
+        if (!first) {
+            out += ',';
+        }
+        out.append(field);
     }
+
+    template <typename Number, typename = enable_if_t<is_arithmetic_v<Number>>>
+    static void appendField(string &out, Number value, bool first) {
+        char digits[32];
+        auto result = to_chars(digits, digits + sizeof(digits), value);
+        appendField(out, string_view(digits, static_cast<size_t>(result.ptr - digits)), first);
+    }
+
+    bool writeBatch(bool sync) {
+        if (fd < 0) {
+            return false;
+        }
+        size_t done = 0;
+        while (done < buffer.size()) {
+            ssize_t n = ::write(fd, buffer.data() + done, buffer.size() - done);
+            if (n < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                cout << "Unable to write to " << path << ".\n";
+                // Keep only what did not reach the file, so a retry does not write it twice
+                buffer.erase(0, done);
+                batchStart = chrono::steady_clock::now(); // The timer retries after another maxBatchAge
+                bytesWritten += done;
+                Stats::addBytesWritten(fileBytes, done);
+                return false;
+            }
+            done += static_cast<size_t>(n);
+        }
+        if (done == 0) {
+            return true;
+        }
+        bytesWritten += done;
+        Stats::addBytesWritten(fileBytes, done);
+        buffer.clear();
+        if (sync && ::fdatasync(fd) != 0) {
+            cout << "Unable to sync " << path << ".\n";
+            return false;
+        }
+        return true;
+    }
+};
+
+// Hands journal records to a background thread so the thread serving a
+// customer never waits on the disk. Producers claim a slot in a bounded
+// lock-free ring (any number of producers, one consumer; every slot carries
+// a sequence number saying whose turn it is) and the writer thread appends
+// the records to their JournalWriter and commits once per batch.
+// When the ring is full the backpressure policy decides what happens:
+//   block  wait for a free slot; nothing is lost
+//   drop   discard the record and count it
+//   spill  put it on an unbounded overflow list that the writer empties after
+//          the ring, so spilled records may land after ones queued later
+// CANTEEN_BACKPRESSURE=block|drop|spill picks the policy, block if unset.
+// shutdown() writes out everything queued and stops the thread; the
+// destructor calls it, so the process-wide instance drains at exit.
+class AsyncJournal {
+public:
+    enum class Backpressure { Block, Drop, Spill };
+
+    // Created on the first submit, after the JournalWriter registry, so it is drained before writers close
+    static AsyncJournal &instance() {
+        static AsyncJournal queue(4096, defaultBackpressure());
+        return queue;
+    }
+
+    static Backpressure defaultBackpressure() {
+        const char *mode = getenv("CANTEEN_BACKPRESSURE");
+        if (mode != nullptr && string(mode) == "drop") {
+            return Backpressure::Drop;
+        }
+        if (mode != nullptr && string(mode) == "spill") {
+            return Backpressure::Spill;
+        }
+        return Backpressure::Block;
+    }
+
+    // Capacity is rounded up to a power of two
+    AsyncJournal(size_t capacity, Backpressure policy) : policy(policy) {
+        size_t size = 2;
+        while (size < capacity) {
+            size *= 2;
+        }
+        mask = size - 1;
+        cells.reset(new Cell[size]);
+        for (size_t i = 0; i < size; ++i) {
+            cells[i].sequence.store(i, memory_order_relaxed);
+        }
+        writer = thread([this] { run(); });
+    }
+
+    ~AsyncJournal() { shutdown(); }
+
+    AsyncJournal(const AsyncJournal &) = delete;
+    AsyncJournal &operator=(const AsyncJournal &) = delete;
+
+    // Queues one record (without its newline) for journal; returns false if it was dropped.
+    // Once shutdown() has begun, records are written on the calling thread
+    // instead, after the writer has finished with everything queued before.
+    bool submit(JournalWriter &journal, string record) {
+        // The writer does not exit while a producer is between here and the end of its push
+        inFlight.fetch_add(1, memory_order_seq_cst);
+        if (stopped.load(memory_order_seq_cst)) {
+            inFlight.fetch_sub(1, memory_order_release);
+            waitForWriterExit();
+            journal.append(record);
+            journal.commit();
+            return true;
+        }
+        bool queued = push(journal, record);
+        if (queued) {
+            submitted.fetch_add(1, memory_order_release);
+            wake();
+        }
+        inFlight.fetch_sub(1, memory_order_release);
+        return queued;
+    }
+
+    // Returns once every record submitted before the call has been written
+    void drain() {
+        uint64_t target = submitted.load(memory_order_acquire);
+        unique_lock<mutex> lock(stateMtx);
+        while (written < target && !writerDone) {
+            writerIdle.notify_one();
+            writtenChanged.wait_for(lock, chrono::milliseconds(10));
+        }
+    }
+
+    // Stops taking records into the ring, lets the writer write out everything
+    // already submitted or being submitted, then stops the writer thread
+    void shutdown() {
+        {
+            lock_guard<mutex> lock(stateMtx);
+            if (stopping) {
+                return;
+            }
+            stopping = true;
+        }
+        stopped.store(true, memory_order_seq_cst);
+        {
+            lock_guard<mutex> lock(stateMtx);
+            writerIdle.notify_one();
+        }
+        writer.join();
+        lock_guard<mutex> lock(stateMtx);
+        writerDone = true;
+        writtenChanged.notify_all();
+    }
+
+private:
+    struct alignas(64) Cell {
+        atomic<size_t> sequence; // Equal to the claiming position when free, one past it when full
+        JournalWriter *journal = nullptr;
+        string record;
+    };
+
+    Backpressure policy;
+    unique_ptr<Cell[]> cells;
+    size_t mask;
+    alignas(64) atomic<size_t> tail{0}; // Next position producers claim
+    alignas(64) size_t head = 0;        // Next position the writer reads; only the writer touches it
+    atomic<uint64_t> submitted{0};      // Records queued or spilled, never dropped ones
+    atomic<unsigned> inFlight{0};       // Producers inside submit() that may still push
+    atomic<unsigned> blocked{0};        // Producers waiting for a free slot
+    atomic<bool> sleeping{false};
+    atomic<bool> hasOverflow{false};
+    atomic<bool> stopped{false};        // Set by shutdown(): no new records go into the ring
+
+    mutex stateMtx; // Guards overflow, written, stopping and writerDone, and backs the condition variables
+    condition_variable writerIdle;
+    condition_variable writtenChanged;
+    condition_variable slotFreed;
+    deque<pair<JournalWriter *, string>> overflow;
+    uint64_t written = 0;
+    bool stopping = false;
+    bool writerDone = false;
+    thread writer;
+
+    // Applies the backpressure policy when the ring is full; false if the record was dropped
+    bool push(JournalWriter &journal, string &record) {
+        if (tryPush(journal, record)) {
+            Stats::countWriter(Stats::WriterQueued);
+            return true;
+        }
+        if (policy == Backpressure::Drop) {
+            Stats::countWriter(Stats::WriterDropped);
+            return false;
+        }
+        if (policy == Backpressure::Spill) {
+            Stats::countWriter(Stats::WriterSpilled);
+            lock_guard<mutex> lock(stateMtx);
+            overflow.emplace_back(&journal, move(record));
+            hasOverflow.store(true, memory_order_release);
+            return true;
+        }
+        Stats::countWriter(Stats::WriterBlocked);
+        unique_lock<mutex> lock(stateMtx);
+        blocked.fetch_add(1, memory_order_seq_cst); // Pairs with the writer's fence after it frees slots
+        while (!tryPush(journal, record)) {
+            writerIdle.notify_one();
+            slotFreed.wait(lock);
+        }
+        blocked.fetch_sub(1, memory_order_relaxed);
+        Stats::countWriter(Stats::WriterQueued);
+        return true;
+    }
+
+    void waitForWriterExit() {
+        unique_lock<mutex> lock(stateMtx);
+        writtenChanged.wait(lock, [this] { return writerDone; });
+    }
+
+    bool tryPush(JournalWriter &journal, string &record) {
+        size_t pos = tail.load(memory_order_relaxed);
+        for (;;) {
+            Cell &cell = cells[pos & mask];
+            size_t sequence = cell.sequence.load(memory_order_acquire);
+            intptr_t lag = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(pos);
+            if (lag == 0) {
+                if (tail.compare_exchange_weak(pos, pos + 1, memory_order_relaxed)) {
+                    cell.journal = &journal;
+                    cell.record = move(record);
+                    cell.sequence.store(pos + 1, memory_order_release);
+                    return true;
+                }
+            } else if (lag < 0) {
+                return false; // The slot still holds a record from one lap ago: full
+            } else {
+                pos = tail.load(memory_order_relaxed); // Another producer took it
+            }
+        }
+    }
+
+    bool tryPop(JournalWriter *&journal, string &record) {
+        Cell &cell = cells[head & mask];
+        if (cell.sequence.load(memory_order_acquire) != head + 1) {
+            return false;
+        }
+        journal = cell.journal;
+        record = move(cell.record);
+        cell.sequence.store(head + mask + 1, memory_order_release); // Free for the next lap
+        ++head;
+        return true;
+    }
+
+    // Only takes the lock when the writer has gone to sleep
+    void wake() {
+        atomic_thread_fence(memory_order_seq_cst);
+        if (sleeping.load(memory_order_relaxed)) {
+            lock_guard<mutex> lock(stateMtx);
+            writerIdle.notify_one();
+        }
+    }
+
+    void run() {
+        vector<JournalWriter *> touched;
+        JournalWriter *journal;
+        string record;
+        for (;;) {
+            uint64_t batch = 0;
+            while (tryPop(journal, record)) {
+                journal->append(record);
+                if (find(touched.begin(), touched.end(), journal) == touched.end()) {
+                    touched.push_back(journal);
+                }
+                ++batch;
+            }
+            atomic_thread_fence(memory_order_seq_cst);
+            if (batch > 0 && blocked.load(memory_order_relaxed) > 0) {
+                lock_guard<mutex> lock(stateMtx);
+                slotFreed.notify_all();
+            }
+            if (hasOverflow.load(memory_order_acquire)) {
+                deque<pair<JournalWriter *, string>> spilled;
+                {
+                    lock_guard<mutex> lock(stateMtx);
+                    spilled.swap(overflow);
+                    hasOverflow.store(false, memory_order_relaxed);
+                }
+                for (auto &entry : spilled) {
+                    entry.first->append(entry.second);
+                    if (find(touched.begin(), touched.end(), entry.first) == touched.end()) {
+                        touched.push_back(entry.first);
+                    }
+                    ++batch;
+                }
+            }
+            if (batch > 0) {
+                for (JournalWriter *target : touched) {
+                    target->commit();
+                }
+                touched.clear();
+                lock_guard<mutex> lock(stateMtx);
+                written += batch;
+                writtenChanged.notify_all();
+                continue;
+            }
+
+            unique_lock<mutex> lock(stateMtx);
+            sleeping.store(true, memory_order_relaxed);
+            atomic_thread_fence(memory_order_seq_cst);
+            // Read before the ring: a producer that has left submit() published its record first
+            bool producing = inFlight.load(memory_order_acquire) > 0;
+            bool pending = cells[head & mask].sequence.load(memory_order_acquire) == head + 1 || !overflow.empty();
+            if (!pending && !producing && stopped.load(memory_order_acquire)) {
+                return;
+            }
+            if (!pending) {
+                // The timeout covers a producer that checked sleeping just before it was set
+                writerIdle.wait_for(lock, chrono::milliseconds(50));
+            }
+            sleeping.store(false, memory_order_relaxed);
+        }
+    }
+};
+
+// One placed order as stored in orders.csv, one row per order:
+//   timestamp,employeeID,lineCount,itemID,quantity,unitPrice[,itemID,quantity,unitPrice...]
+// The timestamp is in seconds since the epoch. An item ID is the item's
+// record number in the inventory snapshot. Snapshots keep items in the order
+// they were added and never drop one, so an ID names the same item through
+// every compaction and --convert-inventory; readers turn it back into a name
+// with itemNameOf(). Lines are allocated from the memory resource the record
+// is built with, normally an arena owned by the session or the log.
+struct OrderRecord {
+    struct Line {
+        uint32_t itemID;
+        int quantity;
+        double unitPrice;
+    };
+
+    int64_t timestamp = 0;
+    int employeeID = 0;
+    pmr::vector<Line> lines;
+
+    explicit OrderRecord(pmr::memory_resource *arena = pmr::get_default_resource()) : lines(arena) {}
+
+    double total() const {
+        double sum = 0.0;
+        for (const auto &line : lines) {
+            sum += line.quantity * line.unitPrice;
+        }
+        return sum;
+    }
+
+    // Formats the row into out in a single pass, without the trailing newline
+    void format(string &out) const {
+        out.resize(64 + lines.size() * 48); // Widest timestamp, ID and count, then widest line fields
+        char *p = &out[0];
+        char *end = p + out.size();
+        p = to_chars(p, end, timestamp).ptr;
+        *p++ = ',';
+        p = to_chars(p, end, employeeID).ptr;
+        *p++ = ',';
+        p = to_chars(p, end, lines.size()).ptr;
+        for (const auto &line : lines) {
+            *p++ = ',';
+            p = to_chars(p, end, line.itemID).ptr;
+            *p++ = ',';
+            p = to_chars(p, end, line.quantity).ptr;
+            *p++ = ',';
+            p = to_chars(p, end, line.unitPrice).ptr;
+        }
+        out.resize(static_cast<size_t>(p - out.data()));
+    }
+
+    // Fills the record from a row split by CsvReader; returns the problem, or nullptr if none
+    const char *parse(const vector<string_view> &fields) {
+        size_t lineCount = 0;
+        if (fields.size() < 3) {
+            return "expected at least 3 fields";
+        }
+        if (!CsvReader::parseInt(fields[0], timestamp) || !CsvReader::parseInt(fields[1], employeeID) ||
+            !CsvReader::parseInt(fields[2], lineCount)) {
+            return "bad timestamp, employee ID or line count";
+        }
+        if (fields.size() != 3 + lineCount * 3) {
+            return "line count does not match the fields";
+        }
+        lines.clear();
+        lines.reserve(lineCount);
+        for (size_t i = 3; i < fields.size(); i += 3) {
+            Line line;
+            if (!CsvReader::parseInt(fields[i], line.itemID) || !CsvReader::parseInt(fields[i + 1], line.quantity) ||
+                !CsvReader::parseDouble(fields[i + 2], line.unitPrice)) {
+                return "bad order line";
+            }
+            lines.push_back(line);
+        }
+        return nullptr;
+    }
+
+    // Fills the record straight from one row's text without splitting it into fields first.
+    // Returns false on anything unexpected; parse() then says what was wrong.
+    bool parseLine(string_view row) {
+        const char *p = row.data();
+        const char *end = p + row.size();
+        // Each field must be followed by a comma or the end of the row
+        auto field = [&p, end](auto &value) {
+            auto result = from_chars(p, end, value);
+            if (result.ec != errc() || (result.ptr != end && *result.ptr != ',')) {
+                return false;
+            }
+            p = result.ptr == end ? end : result.ptr + 1;
+            return true;
+        };
+        size_t lineCount = 0;
+        if (!field(timestamp) || !field(employeeID) || !field(lineCount)) {
+            return false;
+        }
+        lines.clear();
+        for (size_t i = 0; i < lineCount; ++i) {
+            Line line;
+            if (!field(line.itemID) || !field(line.quantity) || !field(line.unitPrice)) {
+                return false;
+            }
+            lines.push_back(line);
+        }
+        return p == end && row.back() != ',';
+    }
+
+    // Writes the record as one orders.csv row; false if the file could not be opened
+    bool writeTo(JournalWriter &journal) const {
+        thread_local string row;
+        if (!journal.isOpen()) {
+            return false;
+        }
+        format(row);
+        journal.append(row);
+        journal.commit();
+        return true;
+    }
+};
+
+// Name of an item ID from orders.csv or the sales summary, given the current inventory
+string itemNameOf(const vector<InventoryItem> &inventory, uint32_t itemID) {
+    return itemID < inventory.size() ? inventory[itemID].itemName : "Item #" + to_string(itemID);
+}
+
+// Orders read back from orders.csv. All their lines live in the log's arena,
+// so loading allocates in large blocks and everything is freed at once.
+struct OrderLog {
+    pmr::monotonic_buffer_resource arena;
+    vector<OrderRecord> records;
+    size_t legacyRows = 0; // Free-text rows written before orders were structured
 };
 
-int main() {
+// Loads orders.csv into log; returns false if the file could not be opened
+bool loadOrders(const string &path, OrderLog &log, bool report = true) {
+    CsvReader reader(path);
+    if (!reader.isOpen()) {
+        return false;
+    }
+
+    vector<string_view> fields;
+    while (reader.nextRow(fields)) {
+        if (fields[0].rfind("Employee ID:", 0) == 0) {
+            ++log.legacyRows;
+            continue;
+        }
+        OrderRecord record(&log.arena);
+        if (const char *problem = record.parse(fields)) {
+            reader.malformed(problem);
+        } else {
+            log.records.push_back(move(record));
+        }
+    }
+    if (report) {
+        reportCsvErrors(path, reader);
+    }
+    return true;
+}
+
+// Sales totals over orders.csv: quantity and revenue per item and per employee,
+// and sales per hour of the day and per day. The file is mapped and cut at line boundaries
+// into one chunk per thread; each thread totals its chunk into its own hash
+// maps and the maps are merged at the end. Revenue is summed in whole cents,
+// so the totals do not depend on how the file was split.
+class SalesReport {
+public:
+    struct Totals {
+        uint64_t orders = 0;
+        int64_t quantity = 0;
+        int64_t revenueCents = 0;
+
+        void add(const Totals &other) {
+            orders += other.orders;
+            quantity += other.quantity;
+            revenueCents += other.revenueCents;
+        }
+    };
+
+    struct Ranked {
+        uint32_t item;
+        Totals totals;
+    };
+
+    Totals overall;
+    unordered_map<uint32_t, Totals> items;   // Keyed by stable item ID, see OrderRecord
+    unordered_map<int, Totals> employees;    // Keyed by employee ID
+    Totals hours[24];                        // Local hour the order was placed
+    unordered_map<int, Totals> days;         // Keyed by local date as YYYYMMDD
+    size_t legacyRows = 0;                   // Free-text rows written before orders were structured
+    vector<CsvReader::ParseError> errors;    // Line numbers count from the top of the file
+    size_t linesRead = 0;                    // Rows seen, blank and skipped ones included
+    uint64_t bytesRead = 0;                  // Through the end of the last complete row
+
+    // Totals every complete row of path on up to threads threads, adding to what is
+    // already here; returns false if the file could not be read. A last row without
+    // its newline is still being written and is left for the next load.
+    bool load(const string &path, unsigned threads = max(1u, thread::hardware_concurrency())) {
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0) {
+            return false;
+        }
+        struct stat info;
+        if (fstat(fd, &info) != 0) {
+            ::close(fd);
+            return false;
+        }
+        size_t size = static_cast<size_t>(info.st_size);
+        if (size == 0) {
+            ::close(fd);
+            return true;
+        }
+        void *data = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+        ::close(fd);
+        if (data == MAP_FAILED) {
+            return false;
+        }
+        madvise(data, size, MADV_SEQUENTIAL);
+        Stats::addBytesRead(path, size);
+        const size_t mappedSize = size;
+        string_view text(static_cast<const char *>(data), size);
+        size = text.rfind('\n') + 1; // 0 when there is no complete row
+        text = text.substr(0, size);
+
+        // Chunks of at least minChunkBytes, each ending just after a newline
+        size_t chunks = max<size_t>(1, min<size_t>(threads, size / minChunkBytes));
+        vector<size_t> bounds{0};
+        for (size_t i = 1; i < chunks; ++i) {
+            size_t cut = text.find('\n', max(bounds.back(), size / chunks * i));
+            if (cut == string_view::npos) {
+                break;
+            }
+            bounds.push_back(cut + 1);
+        }
+        bounds.push_back(size);
+        if (size == 0) {
+            munmap(data, mappedSize);
+            return true;
+        }
+
+        const long utcOffset = localUtcOffset();
+        vector<SalesReport> parts(bounds.size() - 1);
+        vector<thread> workers;
+        for (size_t i = 1; i < parts.size(); ++i) {
+            workers.emplace_back([&, i] { parts[i].total(text.substr(bounds[i], bounds[i + 1] - bounds[i]), utcOffset); });
+        }
+        parts[0].total(text.substr(0, bounds[1]), utcOffset);
+        for (auto &worker : workers) {
+            worker.join();
+        }
+        munmap(data, mappedSize);
+
+        for (const auto &part : parts) {
+            merge(part, linesRead);
+            linesRead += part.linesRead;
+        }
+        bytesRead += size;
+        return true;
+    }
+
+    // Totals rows that follow what has been read so far; text must end just after a newline
+    void addRows(string_view text) {
+        total(text, localUtcOffset());
+        bytesRead += text.size();
+    }
+
+    // 20251009 for the given day counted from 1970-01-01
+    static int civilDate(int64_t day) {
+        day += 719468; // Days from 0000-03-01, so leap days fall at the end of a year
+        int64_t era = (day >= 0 ? day : day - 146096) / 146097;
+        int64_t dayOfEra = day - era * 146097;
+        int64_t yearOfEra = (dayOfEra - dayOfEra / 1460 + dayOfEra / 36524 - dayOfEra / 146096) / 365;
+        int64_t dayOfYear = dayOfEra - (365 * yearOfEra + yearOfEra / 4 - yearOfEra / 100);
+        int64_t shiftedMonth = (5 * dayOfYear + 2) / 153;
+        int64_t dayOfMonth = dayOfYear - (153 * shiftedMonth + 2) / 5 + 1;
+        int64_t month = shiftedMonth < 10 ? shiftedMonth + 3 : shiftedMonth - 9;
+        int64_t year = yearOfEra + era * 400 + (month <= 2);
+        return static_cast<int>(year * 10000 + month * 100 + dayOfMonth);
+    }
+
+    // Best sellers first; ties go to the lower item ID
+    vector<Ranked> topItems(size_t n, bool byRevenue) const {
+        vector<Ranked> ranked;
+        ranked.reserve(items.size());
+        for (const auto &entry : items) {
+            ranked.push_back({entry.first, entry.second});
+        }
+        auto key = [byRevenue](const Ranked &r) { return byRevenue ? r.totals.revenueCents : r.totals.quantity; };
+        n = min(n, ranked.size());
+        partial_sort(ranked.begin(), ranked.begin() + n, ranked.end(), [&key](const Ranked &a, const Ranked &b) {
+            return key(a) != key(b) ? key(a) > key(b) : a.item < b.item;
+        });
+        ranked.resize(n);
+        return ranked;
+    }
+
+    // "1234.50"
+    static string formatCents(int64_t cents) {
+        char text[32];
+        snprintf(text, sizeof(text), "%s%lld.%02lld", cents < 0 ? "-" : "", llabs(cents) / 100LL, llabs(cents) % 100LL);
+        return text;
+    }
+
+private:
+    static constexpr size_t minChunkBytes = 1 << 20;
+
+    // Offset in effect now; orders from the other side of a daylight saving change land an hour off
+    static long localUtcOffset() {
+        time_t now = time(nullptr);
+        tm local{};
+        localtime_r(&now, &local);
+        return local.tm_gmtoff;
+    }
+
+    // Rows go through OrderRecord::parseLine; only the rare row it rejects is split
+    // into fields to tell a legacy row from a malformed one
+    void total(string_view text, long utcOffset) {
+        OrderRecord order;
+        vector<string_view> fields;
+        int64_t cachedDay = INT64_MIN;
+        int cachedDate = 0;
+        while (!text.empty()) {
+            size_t eol = text.find('\n');
+            string_view row = text.substr(0, eol);
+            text.remove_prefix(eol == string_view::npos ? text.size() : eol + 1);
+            ++linesRead;
+            if (!row.empty() && row.back() == '\r') {
+                row.remove_suffix(1);
+            }
+            if (row.empty()) {
+                continue;
+            }
+            if (!order.parseLine(row)) {
+                CsvReader reader = CsvReader::overText(row);
+                reader.nextRow(fields);
+                if (fields[0].rfind("Employee ID:", 0) == 0) {
+                    ++legacyRows;
+                    continue;
+                }
+                if (const char *problem = order.parse(fields)) {
+                    errors.push_back({linesRead, problem});
+                    continue;
+                }
+            }
+
+            Totals sale;
+            sale.orders = 1;
+            for (const auto &line : order.lines) {
+                int64_t cents = llround(line.quantity * line.unitPrice * 100.0);
+                Totals &item = items[line.itemID];
+                ++item.orders;
+                item.quantity += line.quantity;
+                item.revenueCents += cents;
+                sale.quantity += line.quantity;
+                sale.revenueCents += cents;
+            }
+            employees[order.employeeID].add(sale);
+            int64_t local = order.timestamp + utcOffset;
+            int64_t day = (local >= 0 ? local : local - 86399) / 86400;
+            if (day != cachedDay) {
+                cachedDay = day;
+                cachedDate = civilDate(day);
+            }
+            hours[(local - day * 86400) / 3600].add(sale);
+            days[cachedDate].add(sale);
+            overall.add(sale);
+        }
+    }
+
+    void merge(const SalesReport &part, size_t firstLine) {
+        overall.add(part.overall);
+        for (const auto &entry : part.items) {
+            items[entry.first].add(entry.second);
+        }
+        for (const auto &entry : part.employees) {
+            employees[entry.first].add(entry.second);
+        }
+        for (int hour = 0; hour < 24; ++hour) {
+            hours[hour].add(part.hours[hour]);
+        }
+        for (const auto &entry : part.days) {
+            days[entry.first].add(entry.second);
+        }
+        legacyRows += part.legacyRows;
+        for (const auto &error : part.errors) {
+            errors.push_back({firstLine + error.line, error.reason});
+        }
+    }
+};
+
+// Running sales totals kept in sales_summary.csv so reports need not rescan
+// orders.csv. The summary covers orders.csv up to a checkpoint offset. On
+// startup only the rows appended since then are read, and while running every
+// commit to the orders journal folds in the rows it wrote. Saves are throttled:
+// a summary that is behind is brought up to date from its checkpoint, so a lost
+// save only costs a longer catch-up. Items are keyed by their stable item ID
+// (see OrderRecord). Summaries from before IDs were stable have no format
+// version on their checkpoint and are rebuilt from orders.csv.
+//
+//   #checkpoint,<offset>,<lines>,<legacy rows>,<format version>
+//   item,<item ID>,<orders>,<quantity>,<revenue cents>
+//   employee,<employee ID>,<orders>,<quantity>,<revenue cents>
+//   hour,<0-23>,<orders>,<quantity>,<revenue cents>
+//   day,<YYYYMMDD>,<orders>,<quantity>,<revenue cents>
+class SalesSummary {
+public:
+    static SalesSummary &instance() {
+        static SalesSummary summary(anchoredPath("sales_summary.csv"), anchoredPath("orders.csv"));
+        return summary;
+    }
+
+    SalesSummary(string path, string ordersPath) : path(move(path)), ordersPath(move(ordersPath)) {
+        load();
+        reportCsvErrors(this->ordersPath, catchUp());
+        JournalWriter::forFile(this->ordersPath).setCommitListener([this] { catchUp(); });
+    }
+
+    ~SalesSummary() {
+        JournalWriter::forFile(ordersPath).setCommitListener(nullptr);
+        lock_guard<mutex> lock(mtx);
+        if (report.bytesRead != savedOffset) {
+            save();
+        }
+    }
+
+    SalesSummary(const SalesSummary &) = delete;
+    SalesSummary &operator=(const SalesSummary &) = delete;
+
+    // Copy of the totals as of the last catch-up
+    SalesReport totals() const {
+        lock_guard<mutex> lock(mtx);
+        return report;
+    }
+
+    // Folds in the complete rows appended to orders.csv since the checkpoint and
+    // returns the malformed ones among them. Starts over if the file shrank.
+    vector<CsvReader::ParseError> catchUp() {
+        lock_guard<mutex> lock(mtx);
+        report.errors.clear();
+        int fd = ::open(ordersPath.c_str(), O_RDONLY);
+        struct stat info;
+        if (fd < 0 || fstat(fd, &info) != 0) {
+            if (fd >= 0) {
+                ::close(fd);
+            }
+            return {};
+        }
+        uint64_t size = static_cast<uint64_t>(info.st_size);
+        if (size < report.bytesRead) {
+            report = SalesReport(); // orders.csv was truncated or replaced
+        }
+        if (report.bytesRead == 0 && size > 0) {
+            ::close(fd);
+            report.load(ordersPath); // Whole history: totalled in parallel
+            return finishCatchUp();
+        }
+
+        string tail;
+        size_t blockBytes = readBlockBytes;
+        while (report.bytesRead < size) {
+            tail.resize(static_cast<size_t>(min<uint64_t>(size - report.bytesRead, blockBytes)));
+            ssize_t n = pread(fd, &tail[0], tail.size(), static_cast<off_t>(report.bytesRead));
+            if (n <= 0) {
+                break;
+            }
+            Stats::addBytesRead(ordersBytes, static_cast<size_t>(n));
+            size_t complete = string_view(tail.data(), static_cast<size_t>(n)).rfind('\n');
+            if (complete == string_view::npos) {
+                if (static_cast<size_t>(n) < blockBytes) {
+                    break; // The last row is still being written
+                }
+                blockBytes *= 2; // A row longer than the block
+                continue;
+            }
+            report.addRows(string_view(tail.data(), complete + 1));
+        }
+        ::close(fd);
+        return finishCatchUp();
+    }
+
+private:
+    static constexpr size_t readBlockBytes = 1 << 20;
+    static constexpr uint64_t saveEveryBytes = 1 << 20;
+    static constexpr int formatVersion = 2;
+    static constexpr chrono::seconds saveInterval{5};
+
+    string path;
+    string ordersPath;
+    Stats::FileBytes &ordersBytes = Stats::file(ordersPath);
+    mutable mutex mtx;
+    SalesReport report;       // Totals through report.bytesRead of orders.csv
+    uint64_t savedOffset = 0; // Checkpoint in the file on disk
+    chrono::steady_clock::time_point lastSave = chrono::steady_clock::now();
+
+    vector<CsvReader::ParseError> finishCatchUp() {
+        if (report.bytesRead - savedOffset >= saveEveryBytes ||
+            (report.bytesRead != savedOffset && chrono::steady_clock::now() - lastSave >= saveInterval)) {
+            save();
+        }
+        return move(report.errors);
+    }
+
+    // Anything unexpected discards the whole file; the next catch-up rebuilds it
+    void load() {
+        CsvReader reader(path);
+        if (!reader.isOpen()) {
+            return;
+        }
+        SalesReport loaded;
+        bool checkpointed = false;
+        int version = 0;
+        vector<string_view> fields;
+        while (reader.nextRow(fields)) {
+            if (fields[0] == "#checkpoint") {
+                if (fields.size() == 4) {
+                    cout << "Sales summary " << path << " keys items by their old positions; rebuilding it from "
+                         << ordersPath << ".\n";
+                    return;
+                }
+                checkpointed = fields.size() == 5 && CsvReader::parseInt(fields[1], loaded.bytesRead) &&
+                               CsvReader::parseInt(fields[2], loaded.linesRead) &&
+                               CsvReader::parseInt(fields[3], loaded.legacyRows) &&
+                               CsvReader::parseInt(fields[4], version) && version == formatVersion;
+                if (!checkpointed) {
+                    break;
+                }
+                continue;
+            }
+            int64_t key = 0;
+            SalesReport::Totals totals;
+            if (fields.size() != 5 || !CsvReader::parseInt(fields[1], key) ||
+                !CsvReader::parseInt(fields[2], totals.orders) || !CsvReader::parseInt(fields[3], totals.quantity) ||
+                !CsvReader::parseInt(fields[4], totals.revenueCents)) {
+                checkpointed = false;
+                break;
+            }
+            if (fields[0] == "item" && key >= 0 && key <= UINT32_MAX) {
+                loaded.items[static_cast<uint32_t>(key)] = totals;
+            } else if (fields[0] == "employee" && key >= INT_MIN && key <= INT_MAX) {
+                loaded.employees[static_cast<int>(key)] = totals;
+                loaded.overall.add(totals); // Every order has exactly one employee
+            } else if (fields[0] == "hour" && key >= 0 && key < 24) {
+                loaded.hours[key] = totals;
+            } else if (fields[0] == "day" && key >= 0 && key <= INT_MAX) {
+                loaded.days[static_cast<int>(key)] = totals;
+            } else {
+                checkpointed = false;
+                break;
+            }
+        }
+        if (!checkpointed) {
+            cout << "Sales summary " << path << " is damaged; rebuilding it from " << ordersPath << ".\n";
+            return;
+        }
+        report = move(loaded);
+        savedOffset = report.bytesRead;
+    }
+
+    // Writes the summary through a synced temporary file and an atomic rename
+    void save() {
+        string text = JournalWriter::format("#checkpoint", report.bytesRead, report.linesRead, report.legacyRows,
+                                            formatVersion) + "\n";
+        auto addRow = [&text](const char *kind, auto key, const SalesReport::Totals &totals) {
+            text += JournalWriter::format(kind, key, totals.orders, totals.quantity, totals.revenueCents);
+            text += '\n';
+        };
+        for (const auto &entry : report.items) {
+            addRow("item", entry.first, entry.second);
+        }
+        for (const auto &entry : report.employees) {
+            addRow("employee", entry.first, entry.second);
+        }
+        for (int hour = 0; hour < 24; ++hour) {
+            if (report.hours[hour].orders > 0) {
+                addRow("hour", hour, report.hours[hour]);
+            }
+        }
+        for (const auto &entry : report.days) {
+            addRow("day", entry.first, entry.second);
+        }
+
+        string tmpPath = path + ".tmp";
+        int fd = ::open(tmpPath.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        bool ok = fd >= 0 && ::write(fd, text.data(), text.size()) == static_cast<ssize_t>(text.size()) &&
+                  fdatasync(fd) == 0;
+        if (fd >= 0) {
+            ::close(fd);
+        }
+        if (!ok || rename(tmpPath.c_str(), path.c_str()) != 0) {
+            remove(tmpPath.c_str());
+            return;
+        }
+        Stats::addBytesWritten(path, text.size());
+        savedOffset = report.bytesRead;
+        lastSave = chrono::steady_clock::now();
+    }
+};
+
+// Read-only view of a binary inventory file (inv.bin) mapped into memory.
+// Records have a fixed size and point into a string heap for their names, so
+// opening the file costs the same for ten items or ten million and nothing is
+// parsed. Multi-byte fields are stored in the host's byte order. Records stay
+// in the order they were given, so an item's record number (its item ID in
+// orders.csv and the sales summary) survives every rewrite. Version 3 files
+// follow the records with their numbers sorted by name, and find() is a
+// binary search over that index. Version 2 files kept the records themselves
+// sorted by name and version 1 files are searched linearly; both are still read.
+//
+//   Header  magic "CANTINV1", version, record size, item count, checkpoint lsn, heap size
+//   Records item count x {name offset, name length, quantity, reserved, price}
+//   Index   item count x record number, in name order (version 3)
+//   Heap    all item names back to back
+class BinaryInventory {
+public:
+    struct Header {
+        char magic[8];
+        uint32_t version;
+        uint32_t recordSize;
+        uint64_t itemCount;
+        uint64_t checkpointLsn;
+        uint64_t heapSize;
+    };
+
+    struct Record {
+        uint32_t nameOffset; // Into the heap
+        uint32_t nameLength;
+        int32_t quantity;
+        uint32_t reserved;
+        double price;
+    };
+
+    explicit BinaryInventory(const string &path) {
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0) {
+            return;
+        }
+        struct stat info;
+        if (fstat(fd, &info) == 0 && static_cast<size_t>(info.st_size) >= sizeof(Header)) {
+            mappedSize = static_cast<size_t>(info.st_size);
+            void *data = mmap(nullptr, mappedSize, PROT_READ, MAP_SHARED, fd, 0);
+            mapped = data == MAP_FAILED ? nullptr : static_cast<const char *>(data);
+        }
+        ::close(fd);
+        if (mapped == nullptr) {
+            cout << path << " is not a valid binary inventory file.\n";
+            return;
+        }
+
+        header = reinterpret_cast<const Header *>(mapped);
+        // Item count and heap size are checked against the file before any arithmetic on them can overflow
+        const bool indexed = header->version >= 3;
+        const uint64_t entrySize = sizeof(Record) + (indexed ? sizeof(uint32_t) : 0);
+        const uint64_t maxItems = min<uint64_t>((mappedSize - sizeof(Header)) / entrySize, UINT32_MAX);
+        const uint64_t recordsEnd = sizeof(Header) + min<uint64_t>(header->itemCount, maxItems) * sizeof(Record);
+        const uint64_t indexEnd = recordsEnd + (indexed ? min<uint64_t>(header->itemCount, maxItems) * sizeof(uint32_t) : 0);
+        if (memcmp(header->magic, "CANTINV1", 8) != 0 || header->version < 1 || header->version > 3 ||
+            header->recordSize != sizeof(Record) || header->itemCount > maxItems ||
+            header->heapSize > mappedSize - indexEnd) {
+            cout << path << " is not a valid binary inventory file.\n";
+            unmap();
+            return;
+        }
+        records = reinterpret_cast<const Record *>(mapped + sizeof(Header));
+        index = indexed ? reinterpret_cast<const uint32_t *>(mapped + recordsEnd) : nullptr;
+        heap = mapped + indexEnd;
+        sorted = header->version == 2;
+        Stats::addBytesRead(path, mappedSize);
+    }
+
+    ~BinaryInventory() { unmap(); }
+
+    BinaryInventory(const BinaryInventory &) = delete;
+    BinaryInventory &operator=(const BinaryInventory &) = delete;
+
+    bool isOpen() const { return records != nullptr; }
+    size_t size() const { return isOpen() ? static_cast<size_t>(header->itemCount) : 0; }
+    uint64_t checkpoint() const { return isOpen() ? header->checkpointLsn : 0; }
+
+    string_view name(size_t item) const {
+        const Record &record = records[item];
+        if (uint64_t(record.nameOffset) + record.nameLength > header->heapSize) {
+            return string_view(); // Damaged entry
+        }
+        return string_view(heap + record.nameOffset, record.nameLength);
+    }
+
+    int quantity(size_t item) const { return records[item].quantity; }
+    double price(size_t item) const { return records[item].price; }
+
+    // Record number of the named item, or -1
+    ptrdiff_t find(string_view itemName) const {
+        if (!sorted && index == nullptr) {
+            for (size_t item = 0; item < size(); ++item) {
+                if (name(item) == itemName) {
+                    return static_cast<ptrdiff_t>(item);
+                }
+            }
+            return -1;
+        }
+        // Position i in name order is record index[i], or record i itself in a version 2 file
+        auto recordAt = [this](size_t i) -> size_t { return index != nullptr ? index[i] : i; };
+        size_t low = 0;
+        size_t high = size();
+        while (low < high) {
+            size_t mid = low + (high - low) / 2;
+            size_t record = recordAt(mid);
+            if (record >= size()) {
+                return -1; // Damaged index
+            }
+            if (name(record) < itemName) {
+                low = mid + 1;
+            } else {
+                high = mid;
+            }
+        }
+        if (low == size() || recordAt(low) >= size() || name(recordAt(low)) != itemName) {
+            return -1;
+        }
+        return static_cast<ptrdiff_t>(recordAt(low));
+    }
+
+    // Writes items in the given order, with an index sorted by name, to path
+    // through a synced temporary file and an atomic rename
+    static bool write(const string &path, const vector<InventoryItem> &items, uint64_t checkpointLsn) {
+        Header fileHeader = {{'C', 'A', 'N', 'T', 'I', 'N', 'V', '1'}, 3, sizeof(Record), items.size(), checkpointLsn, 0};
+        if (items.size() > UINT32_MAX) {
+            return false;
+        }
+        vector<Record> table;
+        table.reserve(items.size());
+        string names;
+        for (const auto &item : items) {
+            table.push_back({static_cast<uint32_t>(names.size()), static_cast<uint32_t>(item.itemName.size()),
+                             item.quantity, 0, item.price});
+            names += item.itemName;
+        }
+        fileHeader.heapSize = names.size();
+        vector<uint32_t> byName(items.size());
+        for (size_t record = 0; record < byName.size(); ++record) {
+            byName[record] = static_cast<uint32_t>(record);
+        }
+        sort(byName.begin(), byName.end(),
+             [&items](uint32_t a, uint32_t b) { return items[a].itemName < items[b].itemName; });
+
+        string tmpPath = path + ".tmp";
+        ofstream outFile(tmpPath, ios::binary | ios::trunc);
+        if (!outFile.is_open()) {
+            return false;
+        }
+        outFile.write(reinterpret_cast<const char *>(&fileHeader), sizeof(fileHeader));
+        outFile.write(reinterpret_cast<const char *>(table.data()), static_cast<streamsize>(table.size() * sizeof(Record)));
+        outFile.write(reinterpret_cast<const char *>(byName.data()),
+                      static_cast<streamsize>(byName.size() * sizeof(uint32_t)));
+        outFile.write(names.data(), static_cast<streamsize>(names.size()));
+        outFile.close();
+
+        int fd = ::open(tmpPath.c_str(), O_RDONLY);
+        bool ok = outFile.good() && fd >= 0 && fdatasync(fd) == 0;
+        if (fd >= 0) {
+            ::close(fd);
+        }
+        if (!ok || rename(tmpPath.c_str(), path.c_str()) != 0) {
+            remove(tmpPath.c_str());
+            return false;
+        }
+        Stats::addBytesWritten(path, sizeof(fileHeader) + table.size() * sizeof(Record) +
+                                         byName.size() * sizeof(uint32_t) + names.size());
+        return true;
+    }
+
+private:
+    const char *mapped = nullptr;
+    size_t mappedSize = 0;
+    const Header *header = nullptr;
+    const Record *records = nullptr;
+    const uint32_t *index = nullptr; // Record numbers in name order, version 3 only
+    const char *heap = nullptr;
+    bool sorted = false;             // Records themselves in name order, version 2 only
+
+    void unmap() {
+        if (mapped != nullptr) {
+            munmap(const_cast<char *>(mapped), mappedSize);
+        }
+        mapped = nullptr;
+        records = nullptr;
+    }
+};
+
+// The inventory as parallel columns for reports that scan every item. Slot i
+// is item ID i of the snapshot the columns were built from, so names are
+// looked up there rather than stored again.
+struct InventoryColumns {
+    shared_ptr<const vector<InventoryItem>> items; // Snapshot the columns were built from
+    vector<int32_t> quantities;
+    vector<double> prices;
+    vector<int32_t> reorderLevels; // An item is low on stock below this quantity
+    vector<uint32_t> categories;   // Index into categoryNames
+    vector<string> categoryNames;
+
+    size_t size() const { return quantities.size(); }
+
+    void push_back(int32_t quantity, double price, int32_t reorderLevel, uint32_t category) {
+        quantities.push_back(quantity);
+        prices.push_back(price);
+        reorderLevels.push_back(reorderLevel);
+        categories.push_back(category);
+    }
+};
+
+// Report kernels over InventoryColumns. Each has a portable scalar version
+// and an AVX2 version that is picked at run time when the CPU has it; both
+// produce the same results, including the order floating-point sums are added in.
+bool cpuHasAvx2() {
+#if defined(__x86_64__) || defined(__i386__)
+    static const bool avx2 = __builtin_cpu_supports("avx2");
+    return avx2;
+#else
+    return false;
+#endif
+}
+
+// Appends the IDs of items whose quantity is below their reorder level
+void lowStockScalar(const InventoryColumns &columns, vector<uint32_t> &out) {
+    const int32_t *q = columns.quantities.data();
+    const int32_t *r = columns.reorderLevels.data();
+    for (size_t i = 0, n = columns.size(); i < n; ++i) {
+        if (q[i] < r[i]) {
+            out.push_back(static_cast<uint32_t>(i));
+        }
+    }
+}
+
+// Sum of quantity x price over eight lanes, reduced pairwise at the end
+double stockValueScalar(const InventoryColumns &columns) {
+    const int32_t *q = columns.quantities.data();
+    const double *p = columns.prices.data();
+    size_t n = columns.size();
+    double s[8] = {};
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        for (size_t lane = 0; lane < 8; ++lane) {
+            s[lane] += q[i + lane] * p[i + lane];
+        }
+    }
+    for (; i < n; ++i) {
+        s[0] += q[i] * p[i];
+    }
+    return ((s[0] + s[4]) + (s[1] + s[5])) + ((s[2] + s[6]) + (s[3] + s[7]));
+}
+
+// Stock value per category, indexed like categoryNames. Item i is added to
+// bin set i % 4 so that runs of one category do not wait on each other's
+// stores; the four sets are merged pairwise at the end.
+vector<double> categoryValuesScalar(const InventoryColumns &columns) {
+    size_t bins = columns.categoryNames.size();
+    vector<double> partial(4 * bins, 0.0);
+    const int32_t *q = columns.quantities.data();
+    const double *p = columns.prices.data();
+    const uint32_t *c = columns.categories.data();
+    size_t n = columns.size();
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        for (size_t set = 0; set < 4; ++set) {
+            partial[set * bins + c[i + set]] += q[i + set] * p[i + set];
+        }
+    }
+    for (; i < n; ++i) {
+        partial[c[i]] += q[i] * p[i];
+    }
+    vector<double> sums(bins);
+    for (size_t bin = 0; bin < bins; ++bin) {
+        sums[bin] = (partial[bin] + partial[bins + bin]) + (partial[2 * bins + bin] + partial[3 * bins + bin]);
+    }
+    return sums;
+}
+
+#if defined(__x86_64__) || defined(__i386__)
+__attribute__((target("avx2"))) void lowStockAvx2(const InventoryColumns &columns, vector<uint32_t> &out) {
+    const int32_t *q = columns.quantities.data();
+    const int32_t *r = columns.reorderLevels.data();
+    size_t n = columns.size();
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m256i quantity = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(q + i));
+        __m256i level = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(r + i));
+        unsigned mask = static_cast<unsigned>(_mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpgt_epi32(level, quantity))));
+        while (mask != 0) { // Most blocks have no low items and skip this entirely
+            out.push_back(static_cast<uint32_t>(i + __builtin_ctz(mask)));
+            mask &= mask - 1;
+        }
+    }
+    for (; i < n; ++i) {
+        if (q[i] < r[i]) {
+            out.push_back(static_cast<uint32_t>(i));
+        }
+    }
+}
+
+__attribute__((target("avx2"))) double stockValueAvx2(const InventoryColumns &columns) {
+    const int32_t *q = columns.quantities.data();
+    const double *p = columns.prices.data();
+    size_t n = columns.size();
+    __m256d low = _mm256_setzero_pd(); // Lanes 0-3 of the scalar version
+    __m256d high = _mm256_setzero_pd(); // Lanes 4-7
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m256d q0 = _mm256_cvtepi32_pd(_mm_loadu_si128(reinterpret_cast<const __m128i *>(q + i)));
+        __m256d q1 = _mm256_cvtepi32_pd(_mm_loadu_si128(reinterpret_cast<const __m128i *>(q + i + 4)));
+        low = _mm256_add_pd(low, _mm256_mul_pd(q0, _mm256_loadu_pd(p + i)));
+        high = _mm256_add_pd(high, _mm256_mul_pd(q1, _mm256_loadu_pd(p + i + 4)));
+    }
+    double s[8];
+    _mm256_storeu_pd(s, low);
+    _mm256_storeu_pd(s + 4, high);
+    for (; i < n; ++i) {
+        s[0] += q[i] * p[i];
+    }
+    return ((s[0] + s[4]) + (s[1] + s[5])) + ((s[2] + s[6]) + (s[3] + s[7]));
+}
+
+// Values are computed four at a time; adding them to their category is a
+// scatter, which stays scalar, with the same bin sets as the scalar version
+__attribute__((target("avx2"))) vector<double> categoryValuesAvx2(const InventoryColumns &columns) {
+    size_t bins = columns.categoryNames.size();
+    vector<double> partial(4 * bins, 0.0);
+    const int32_t *q = columns.quantities.data();
+    const double *p = columns.prices.data();
+    const uint32_t *c = columns.categories.data();
+    size_t n = columns.size();
+    alignas(32) double values[4];
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        __m256d quantity = _mm256_cvtepi32_pd(_mm_loadu_si128(reinterpret_cast<const __m128i *>(q + i)));
+        _mm256_store_pd(values, _mm256_mul_pd(quantity, _mm256_loadu_pd(p + i)));
+        partial[c[i]] += values[0];
+        partial[bins + c[i + 1]] += values[1];
+        partial[2 * bins + c[i + 2]] += values[2];
+        partial[3 * bins + c[i + 3]] += values[3];
+    }
+    for (; i < n; ++i) {
+        partial[c[i]] += q[i] * p[i];
+    }
+    vector<double> sums(bins);
+    for (size_t bin = 0; bin < bins; ++bin) {
+        sums[bin] = (partial[bin] + partial[bins + bin]) + (partial[2 * bins + bin] + partial[3 * bins + bin]);
+    }
+    return sums;
+}
+#endif
+
+void lowStockItems(const InventoryColumns &columns, vector<uint32_t> &out) {
+#if defined(__x86_64__) || defined(__i386__)
+    if (cpuHasAvx2()) {
+        return lowStockAvx2(columns, out);
+    }
+#endif
+    lowStockScalar(columns, out);
+}
+
+double stockValue(const InventoryColumns &columns) {
+#if defined(__x86_64__) || defined(__i386__)
+    if (cpuHasAvx2()) {
+        return stockValueAvx2(columns);
+    }
+#endif
+    return stockValueScalar(columns);
+}
+
+vector<double> categoryValues(const InventoryColumns &columns) {
+#if defined(__x86_64__) || defined(__i386__)
+    if (cpuHasAvx2()) {
+        return categoryValuesAvx2(columns);
+    }
+#endif
+    return categoryValuesScalar(columns);
+}
+
+// Finds inventory items from what staff type: names that start with the
+// typed text, or, when none do, names whose beginning is within a couple of
+// edits of it. Case-folded names are kept in one sorted array, so a prefix
+// lookup is a binary search plus a walk over the matching run. An index is
+// built from one snapshot and keeps it, so item IDs always refer to it.
+class ItemSearchIndex {
+public:
+    struct Match {
+        uint32_t item; // Item ID in the snapshot
+        int distance;  // Edits needed; 0 for prefix matches
+    };
+
+    explicit ItemSearchIndex(shared_ptr<const vector<InventoryItem>> snapshot) : items(move(snapshot)) {
+        entries.reserve(items->size());
+        for (size_t i = 0; i < items->size(); ++i) {
+            entries.push_back({EmployeeStore::foldCase((*items)[i].itemName), static_cast<uint32_t>(i)});
+        }
+        sort(entries.begin(), entries.end(), [](const Entry &a, const Entry &b) { return a.name < b.name; });
+    }
+
+    const shared_ptr<const vector<InventoryItem>> &snapshot() const { return items; }
+
+    // Up to limit items whose name starts with query, in name order (an exact match comes first)
+    vector<Match> prefix(const string &query, size_t limit) const {
+        string key = EmployeeStore::foldCase(query);
+        auto it = lower_bound(entries.begin(), entries.end(), key,
+                              [](const Entry &entry, const string &k) { return entry.name < k; });
+        vector<Match> matches;
+        for (; it != entries.end() && matches.size() < limit && it->name.compare(0, key.size(), key) == 0; ++it) {
+            matches.push_back({it->item, 0});
+        }
+        return matches;
+    }
+
+    // Up to limit items whose name starts within maxDistance edits of query, closest first.
+    // The edit-distance table is built one name character (column) at a time.
+    // Sorted neighbours share a prefix, so a name reuses the columns of the
+    // one before it, and once a column is entirely over the bound every name
+    // with that prefix is skipped with one binary search.
+    vector<Match> fuzzy(const string &query, size_t limit, int maxDistance = 2) const {
+        const string key = EmployeeStore::foldCase(query);
+        const size_t rows = key.size() + 1;
+        const size_t maxColumns = key.size() + static_cast<size_t>(maxDistance); // Later characters cannot help
+        vector<int> table((maxColumns + 1) * rows); // Column j: distances from each query prefix to name[0, j)
+        vector<int> best(maxColumns + 1);           // best[j]: closest any prefix of name[0, j) comes to the query
+        for (size_t i = 0; i < rows; ++i) {
+            table[i] = static_cast<int>(i);
+        }
+        best[0] = static_cast<int>(key.size());
+
+        vector<pair<int, size_t>> found; // distance, entry
+        size_t valid = 0;                // Columns 1..valid belong to previous
+        const string *previous = nullptr;
+        size_t e = 0;
+        while (e < entries.size()) {
+            const string &name = entries[e].name;
+            size_t j = 0;
+            if (previous != nullptr) {
+                size_t shared = min(valid, min(previous->size(), name.size()));
+                while (j < shared && (*previous)[j] == name[j]) {
+                    ++j;
+                }
+            }
+            previous = &name;
+            const size_t columns = min(name.size(), maxColumns);
+            bool dead = false;
+            while (j < columns && !dead) {
+                ++j;
+                const int *left = &table[(j - 1) * rows];
+                int *column = &table[j * rows];
+                column[0] = static_cast<int>(j);
+                int columnMin = column[0];
+                for (size_t i = 1; i < rows; ++i) {
+                    int cost = key[i - 1] == name[j - 1] ? 0 : 1;
+                    column[i] = min({left[i - 1] + cost, left[i] + 1, column[i - 1] + 1});
+                    columnMin = min(columnMin, column[i]);
+                }
+                best[j] = min(best[j - 1], column[rows - 1]);
+                dead = columnMin > maxDistance;
+            }
+            valid = j;
+
+            if (dead) {
+                // Every name with this prefix ends up with the same distance, best[j - 1]
+                size_t end = static_cast<size_t>(partition_point(entries.begin() + static_cast<ptrdiff_t>(e), entries.end(),
+                                                                 [&name, j](const Entry &entry) {
+                                                                     return entry.name.compare(0, j, name, 0, j) == 0;
+                                                                 }) - entries.begin());
+                for (; best[j - 1] <= maxDistance && e < end; ++e) {
+                    found.emplace_back(best[j - 1], e);
+                }
+                e = end;
+                continue;
+            }
+            if (best[j] <= maxDistance) {
+                found.emplace_back(best[j], e);
+            }
+            ++e;
+        }
+
+        size_t count = min(limit, found.size());
+        partial_sort(found.begin(), found.begin() + static_cast<ptrdiff_t>(count), found.end());
+        vector<Match> matches;
+        for (size_t i = 0; i < count; ++i) {
+            matches.push_back({entries[found[i].second].item, found[i].first});
+        }
+        return matches;
+    }
+
+private:
+    struct Entry {
+        string name; // Case-folded
+        uint32_t item;
+    };
+
+    shared_ptr<const vector<InventoryItem>> items;
+    vector<Entry> entries;
+};
+
+// Crash-safe inventory shared by Admin and Employee.
+// inv.bin (or inv.csv until the first compaction) holds a snapshot and inv.wal
+// a log of stock deltas made since. Each change is appended to the log before it is applied in memory.
+// On startup the snapshot is mapped and the log replayed on top of it. Items
+// are read straight from the mapped records; only items changed since the
+// snapshot are copied into memory. Once the log holds more records than the
+// snapshot has items it is folded into a new snapshot, so recovery cost stays
+// bounded by the snapshot size. Compaction rewrites inv.csv as well, so readers
+// of the CSV (and the fallback when inv.bin is unreadable) see the same state.
+// Both snapshots keep items in the order they were first added, so an item's
+// position in items() is its item ID for as long as the files live.
+//
+// Snapshot: BinaryInventory, or "#checkpoint,<lsn>" then name,quantity,price rows
+// Log:      lsn,name,delta,price (price left empty when unchanged)
+// Log records with lsn <= checkpoint are already in the snapshot and skipped,
+// which makes a crash between writing a snapshot and truncating the log safe.
+// Other processes may share the files, so every access holds flock on the log
+// and picks up their changes before acting.
+class InventoryStore {
+public:
+    using Snapshot = shared_ptr<const vector<InventoryItem>>;
+
+    static InventoryStore &instance() {
+        static InventoryStore store(anchoredPath("inv.bin"), anchoredPath("inv.csv"), anchoredPath("inv.wal"),
+                                    anchoredPath("inv_settings.csv"));
+        return store;
+    }
+
+    // A store over other files, e.g. in a scratch directory; the program itself uses instance()
+    InventoryStore(string binaryFile, string csvFile, string walFile, string settingsFile)
+        : binaryPath(move(binaryFile)), csvPath(move(csvFile)), walPath(move(walFile)),
+          settingsPath(move(settingsFile)) {
+        walFd = ::open(walPath.c_str(), O_RDWR | O_CREAT | O_APPEND, 0644);
+        if (walFd < 0) {
+            cout << "Unable to open inventory log " << walPath << ".\n";
+        }
+    }
+
+    ~InventoryStore() {
+        if (walFd >= 0) {
+            ::close(walFd);
+        }
+    }
+
+    // Returns the current inventory
+    Snapshot items() {
+        lock_guard<mutex> lock(mtx);
+        FileLock fileLock(walFd);
+        refresh();
+        if (!snapshot) {
+            snapshot = buildSnapshot();
+        }
+        return snapshot;
+    }
+
+    // Current inventory as columns for reports, with reorder levels and
+    // categories from the settings file (name,reorderLevel,category rows)
+    shared_ptr<const InventoryColumns> columns() {
+        lock_guard<mutex> lock(mtx);
+        FileLock fileLock(walFd);
+        refresh();
+        if (!snapshot) {
+            snapshot = buildSnapshot();
+        }
+        refreshSettings();
+        if (!reportColumns || reportColumns->items != snapshot) {
+            reportColumns = buildColumns();
+        }
+        return reportColumns;
+    }
+
+    // Name search over the current inventory
+    shared_ptr<const ItemSearchIndex> searchIndex() {
+        lock_guard<mutex> lock(mtx);
+        FileLock fileLock(walFd);
+        refresh();
+        if (!snapshot) {
+            snapshot = buildSnapshot();
+        }
+        if (!itemSearch || itemSearch->snapshot() != snapshot) {
+            itemSearch = make_shared<const ItemSearchIndex>(snapshot);
+        }
+        return itemSearch;
+    }
+
+    // Records an item's reorder level and category; later rows of the settings file win
+    bool setItemSettings(const string &itemName, int reorderLevel, const string &category) {
+        lock_guard<mutex> lock(mtx);
+        JournalWriter &journal = JournalWriter::forFile(settingsPath);
+        if (!journal.isOpen()) {
+            return false;
+        }
+        journal.append(itemName, reorderLevel, category);
+        return journal.flush(); // Written through so the next columns() rereads it
+    }
+
+    // Forces the next access to reload the snapshot and the whole log
+    void invalidate() {
+        lock_guard<mutex> lock(mtx);
+        loaded = false;
+    }
+
+    // Adds stock to an item, creating it if needed and setting its price
+    bool addStock(const string &itemName, int quantity, double price) {
+        lock_guard<mutex> lock(mtx);
+        FileLock fileLock(walFd);
+        refresh();
+        return logAndApply(itemName, quantity, &price);
+    }
+
+    // Logs stock already reserved elsewhere (see OrderEngine) without a level
+    // check, sold[i] units of names[i], all under one lock. If anyone else
+    // changed the inventory since seenLsn, levels[i] is set to each item's stock
+    // afterwards; otherwise levels is left empty. seenLsn is moved past our records.
+    bool recordSales(const vector<string> &names, const vector<int> &sold, vector<int> &levels, uint64_t &seenLsn) {
+        lock_guard<mutex> lock(mtx);
+        FileLock fileLock(walFd);
+        refresh();
+        bool changedElsewhere = lastLsn != seenLsn;
+        bool ok = true;
+        for (size_t i = 0; i < names.size(); ++i) {
+            if (sold[i] > 0) {
+                ok = logAndApply(names[i], -sold[i], nullptr) && ok;
+            }
+        }
+        levels.clear();
+        if (changedElsewhere) {
+            levels.reserve(names.size());
+            for (const auto &name : names) {
+                const InventoryItem *item = find(name);
+                levels.push_back(item != nullptr ? item->quantity : 0);
+            }
+        }
+        seenLsn = lastLsn;
+        return ok;
+    }
+
+private:
+    static constexpr size_t minRecordsBeforeCompaction = 1000;
+    static constexpr int defaultReorderLevel = 5;
+
+    struct ItemSettings {
+        int reorderLevel;
+        string category;
+    };
+
+    string binaryPath;
+    string csvPath; // Read only while no binary snapshot exists yet
+    string walPath;
+    string settingsPath;
+    Stats::FileBytes &walBytes = Stats::file(walPath);
+    int walFd = -1;
+    mutex mtx;
+
+    unique_ptr<BinaryInventory> binary;             // Mapped snapshot, if inv.bin was loaded
+    unordered_map<size_t, InventoryItem> changed;   // binary record -> its current value, once touched
+    vector<InventoryItem> added;                    // Items not in binary (all of them after a CSV load)
+    unordered_map<string, size_t> addedIndex;       // item name -> slot in added
+    Snapshot snapshot;                              // Whole inventory as one list, rebuilt after changes
+
+    bool loaded = false;
+    uint64_t checkpointLsn = 0; // Last log record folded into the snapshot
+    uint64_t lastLsn = 0;       // Last log record applied in memory
+    size_t walRecords = 0;      // Log records applied on top of the snapshot
+    off_t walOffset = 0;        // How far the log has been read, always the end of a complete record
+    bool tornTail = false;      // Log ends in a partial record past walOffset
+    string snapshotPath; // Whichever of binaryPath and csvPath was loaded
+    uintmax_t snapshotSize = 0;
+    filesystem::file_time_type snapshotTime;
+
+    unordered_map<string, ItemSettings> settings; // item name -> reorder level and category
+    uintmax_t settingsSize = 0;
+    filesystem::file_time_type settingsTime;
+    shared_ptr<const InventoryColumns> reportColumns; // Built from snapshot and settings on demand
+    shared_ptr<const ItemSearchIndex> itemSearch;     // Built from snapshot on demand
+
+    size_t itemCount() const { return (binary ? binary->size() : 0) + added.size(); }
+
+    // Current value of an item, copying it out of the mapped snapshot on first use; null if unknown
+    InventoryItem *find(const string &itemName) {
+        if (binary) {
+            ptrdiff_t record = binary->find(itemName);
+            if (record >= 0) {
+                auto inserted = changed.try_emplace(static_cast<size_t>(record));
+                if (inserted.second) {
+                    inserted.first->second = {itemName, binary->quantity(record), binary->price(record)};
+                }
+                return &inserted.first->second;
+            }
+        }
+        auto it = addedIndex.find(itemName);
+        return it == addedIndex.end() ? nullptr : &added[it->second];
+    }
+
+    void apply(const string &itemName, int delta, const double *price) {
+        InventoryItem *item = find(itemName);
+        if (item == nullptr) {
+            addedIndex.emplace(itemName, added.size());
+            added.push_back({itemName, 0, 0.0});
+            item = &added.back();
+        }
+        item->quantity += delta;
+        if (price != nullptr) {
+            item->price = *price;
+        }
+        snapshot.reset();
+    }
+
+    // Snapshot records in file order with their changes, then the added items
+    Snapshot buildSnapshot() const {
+        auto items = make_shared<vector<InventoryItem>>();
+        items->reserve(itemCount());
+        for (size_t record = 0; binary && record < binary->size(); ++record) {
+            auto it = changed.find(record);
+            if (it != changed.end()) {
+                items->push_back(it->second);
+            } else {
+                items->push_back({string(binary->name(record)), binary->quantity(record), binary->price(record)});
+            }
+        }
+        items->insert(items->end(), added.begin(), added.end());
+        return items;
+    }
+
+    // Rereads the settings file if its size or time changed
+    void refreshSettings() {
+        error_code ec;
+        uintmax_t size = filesystem::file_size(settingsPath, ec);
+        if (ec) {
+            size = 0;
+        }
+        filesystem::file_time_type mtime = filesystem::last_write_time(settingsPath, ec);
+        if (size == settingsSize && mtime == settingsTime) {
+            return;
+        }
+        settingsSize = size;
+        settingsTime = mtime;
+        settings.clear();
+        reportColumns.reset();
+
+        CsvReader reader(settingsPath);
+        vector<string_view> fields;
+        while (reader.nextRow(fields)) {
+            ItemSettings item;
+            if (fields.size() != 3) {
+                reader.malformed("expected 3 fields");
+            } else if (!CsvReader::parseInt(fields[1], item.reorderLevel)) {
+                reader.malformed("bad reorder level");
+            } else {
+                item.category.assign(fields[2]);
+                settings[string(fields[0])] = move(item);
+            }
+        }
+        reportCsvErrors(settingsPath, reader);
+    }
+
+    // Lays the current inventory out as columns; the snapshot must be up to date
+    shared_ptr<const InventoryColumns> buildColumns() const {
+        auto columns = make_shared<InventoryColumns>();
+        columns->items = snapshot;
+        unordered_map<string_view, uint32_t> categoryIDs;
+        auto categoryOf = [&](const string &name) {
+            auto it = categoryIDs.emplace(name, static_cast<uint32_t>(columns->categoryNames.size()));
+            if (it.second) {
+                columns->categoryNames.push_back(name);
+            }
+            return it.first->second;
+        };
+        const string general = "General";
+        categoryOf(general);
+
+        columns->quantities.reserve(snapshot->size());
+        columns->prices.reserve(snapshot->size());
+        columns->reorderLevels.reserve(snapshot->size());
+        columns->categories.reserve(snapshot->size());
+        for (const auto &item : *snapshot) {
+            auto it = settings.find(item.itemName);
+            if (it == settings.end()) {
+                columns->push_back(item.quantity, item.price, defaultReorderLevel, 0);
+            } else {
+                columns->push_back(item.quantity, item.price, it->second.reorderLevel, categoryOf(it->second.category));
+            }
+        }
+        return columns;
+    }
+
+    // Reloads the snapshot if it was replaced, then replays new log records
+    void refresh() {
+        error_code ec;
+        string path = filesystem::exists(binaryPath, ec) ? binaryPath : csvPath;
+        uintmax_t size = filesystem::file_size(path, ec);
+        if (ec) {
+            size = 0;
+        }
+        filesystem::file_time_type mtime = filesystem::last_write_time(path, ec);
+        if (!loaded || path != snapshotPath || size != snapshotSize || mtime != snapshotTime) {
+            snapshotPath = path;
+            loadSnapshot();
+            snapshotSize = size;
+            snapshotTime = mtime;
+            loaded = true;
+        }
+        replayLog();
+        if (walRecords > max(minRecordsBeforeCompaction, itemCount())) {
+            compact();
+        }
+    }
+
+    void loadSnapshot() {
+        changed.clear();
+        added.clear();
+        addedIndex.clear();
+        snapshot.reset();
+        checkpointLsn = 0;
+        binary.reset(new BinaryInventory(binaryPath));
+        if (binary->isOpen()) {
+            checkpointLsn = binary->checkpoint();
+        } else {
+            binary.reset();
+            // Older inv.csv files were append-only, so the same item may appear twice
+            for (const auto &item : loadInventoryCsv(csvPath, true, &checkpointLsn)) {
+                apply(item.itemName, item.quantity, &item.price);
+            }
+        }
+        lastLsn = checkpointLsn;
+        walRecords = 0;
+        walOffset = 0;
+    }
+
+    void replayLog() {
+        if (walFd < 0) {
+            return;
+        }
+        off_t end = lseek(walFd, 0, SEEK_END);
+        if (end < walOffset) {
+            walOffset = 0; // Log was truncated by a compaction elsewhere
+        }
+        tornTail = false;
+        if (end <= walOffset) {
+            return;
+        }
+
+        string text(static_cast<size_t>(end - walOffset), '\0');
+        ssize_t n = pread(walFd, &text[0], text.size(), walOffset);
+        if (n <= 0) {
+            return;
+        }
+        text.resize(static_cast<size_t>(n));
+        Stats::addBytesRead(walBytes, text.size());
+        size_t complete = text.rfind('\n');
+        tornTail = complete + 1 < text.size(); // A torn record, e.g. after a crash mid-write
+        if (complete == string::npos) {
+            return;
+        }
+        text.resize(complete + 1);
+        walOffset += static_cast<off_t>(text.size());
+
+        CsvReader reader = CsvReader::fromBuffer(move(text));
+        vector<string_view> fields;
+        while (reader.nextRow(fields)) {
+            uint64_t lsn;
+            int delta;
+            double price;
+            if (fields.size() != 4 || !CsvReader::parseInt(fields[0], lsn) || !CsvReader::parseInt(fields[2], delta)) {
+                reader.malformed("bad log record");
+            } else if (!fields[3].empty() && !CsvReader::parseDouble(fields[3], price)) {
+                reader.malformed("bad price");
+            } else if (lsn > checkpointLsn) {
+                apply(string(fields[1]), delta, fields[3].empty() ? nullptr : &price);
+                lastLsn = max(lastLsn, lsn);
+                ++walRecords;
+            }
+        }
+        reportCsvErrors(walPath, reader);
+    }
+
+    static bool writeAll(int fd, const string &data) {
+        size_t done = 0;
+        while (done < data.size()) {
+            ssize_t n = ::write(fd, data.data() + done, data.size() - done);
+            if (n < 0 && errno != EINTR) {
+                return false;
+            }
+            done += n > 0 ? static_cast<size_t>(n) : 0;
+        }
+        return true;
+    }
+
+    static void appendNumber(string &out, double value) {
+        char digits[32];
+        auto result = to_chars(digits, digits + sizeof(digits), value);
+        out.append(digits, result.ptr);
+    }
+
+    bool logAndApply(const string &itemName, int delta, const double *price) {
+        string record = to_string(lastLsn + 1) + "," + itemName + "," + to_string(delta) + ",";
+        if (price != nullptr) {
+            appendNumber(record, *price);
+        }
+        record += '\n';
+
+        // Cut off a record torn by a crash mid-write, or this one would be
+        // appended to its remains and both lost on the next replay
+        if (walFd >= 0 && tornTail) {
+            if (ftruncate(walFd, walOffset) != 0) {
+                cout << "Unable to write to inventory log " << walPath << ".\n";
+                return false;
+            }
+            tornTail = false;
+        }
+        if (walFd < 0 || !writeAll(walFd, record)) {
+            cout << "Unable to write to inventory log " << walPath << ".\n";
+            return false;
+        }
+        if (JournalWriter::defaultDurability() == JournalWriter::Durability::Fdatasync) {
+            fdatasync(walFd);
+        }
+        walOffset += static_cast<off_t>(record.size());
+        Stats::addBytesWritten(walBytes, record.size());
+        ++lastLsn;
+        ++walRecords;
+        apply(itemName, delta, price);
+
+        if (walRecords > max(minRecordsBeforeCompaction, itemCount())) {
+            compact();
+        }
+        return true;
+    }
+
+    // Writes the current state as new CSV and binary snapshots, then empties
+    // the log and maps the new binary snapshot
+    void compact() {
+        Snapshot current = snapshot ? snapshot : buildSnapshot();
+        if (!writeCsvSnapshot(csvPath, *current, lastLsn) || !BinaryInventory::write(binaryPath, *current, lastLsn)) {
+            return; // Keep the log; compaction is retried on the next change
+        }
+
+        uint64_t folded = lastLsn;
+        ftruncate(walFd, 0); // If this fails the records are skipped as already checkpointed
+        tornTail = false;
+        snapshotPath = binaryPath;
+        loadSnapshot();
+        if (checkpointLsn != folded) {
+            loaded = false; // Not the file just written: reload it and the log on the next access
+        }
+        error_code ec;
+        snapshotSize = filesystem::file_size(snapshotPath, ec);
+        snapshotTime = filesystem::last_write_time(snapshotPath, ec);
+    }
+
+    // Same layout loadInventoryCsv reads, written through a synced temporary file and an atomic rename
+    static bool writeCsvSnapshot(const string &path, const vector<InventoryItem> &items, uint64_t checkpointLsn) {
+        string text = JournalWriter::format("#checkpoint", checkpointLsn) + "\n";
+        for (const auto &item : items) {
+            text += JournalWriter::format(item.itemName, item.quantity, item.price);
+            text += '\n';
+        }
+        string tmpPath = path + ".tmp";
+        int fd = ::open(tmpPath.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        bool ok = fd >= 0 && writeAll(fd, text) && fdatasync(fd) == 0;
+        if (fd >= 0) {
+            ::close(fd);
+        }
+        if (!ok || rename(tmpPath.c_str(), path.c_str()) != 0) {
+            remove(tmpPath.c_str());
+            return false;
+        }
+        Stats::addBytesWritten(path, text.size());
+        return true;
+    }
+};
+
+// In-process order service that many worker threads can call at once.
+// Each item's stock is its own atomic counter and is reserved with
+// compare-and-swap, so concurrent orders never oversell and never wait on a
+// shared lock. Sold quantities are tallied per item and written to the
+// inventory log in batches. Each batch also reads back the logged stock
+// levels, so restocks and sales made by other processes are folded in at
+// every sync; between syncs the engine is the only seller it knows of.
+// Employee::orderItems places console orders through one engine per process.
+class OrderEngine {
+public:
+    struct OrderLine {
+        size_t item;  // Index into the engine's item list, also the item ID written to the order journal
+        int quantity;
+    };
+
+    OrderEngine(const vector<InventoryItem> &items, InventoryStore *store = nullptr,
+                JournalWriter *orderJournal = nullptr, unsigned syncInterval = 256)
+        : count(items.size()), slots(new Slot[items.size()]), store(store),
+          orderJournal(orderJournal), syncInterval(syncInterval) {
+        for (size_t i = 0; i < count; ++i) {
+            slots[i].name = items[i].itemName;
+            slots[i].price = items[i].price;
+            slots[i].stock.store(items[i].quantity, memory_order_relaxed);
+            slots[i].logged = items[i].quantity;
+        }
+    }
+
+    ~OrderEngine() { syncSales(); }
+
+    size_t itemCount() const { return count; }
+    const string &itemName(size_t item) const { return slots[item].name; }
+    double price(size_t item) const { return slots[item].price; }
+    int stock(size_t item) const { return slots[item].stock.load(memory_order_acquire); }
+
+    // Takes quantity of one item; returns false if not enough is left
+    bool reserve(size_t item, int quantity) {
+        atomic<int> &stock = slots[item].stock;
+        int current = stock.load(memory_order_relaxed);
+        do {
+            if (current < quantity) {
+                return false;
+            }
+        } while (!stock.compare_exchange_weak(current, current - quantity, memory_order_acq_rel,
+                                              memory_order_relaxed));
+        return true;
+    }
+
+    // Returns quantity taken by reserve()
+    void release(size_t item, int quantity) { slots[item].stock.fetch_add(quantity, memory_order_acq_rel); }
+
+    // True if the engine sells exactly these items in this order
+    bool sells(const vector<InventoryItem> &items) const {
+        if (items.size() != count) {
+            return false;
+        }
+        for (size_t i = 0; i < count; ++i) {
+            if (items[i].itemName != slots[i].name) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    // Counts lines already taken with reserve() as sold, for callers that
+    // reserve one line at a time as a customer picks items
+    void confirm(const vector<OrderLine> &lines) {
+        for (const auto &line : lines) {
+            slots[line.item].unsynced.fetch_add(line.quantity, memory_order_relaxed);
+        }
+        orderPlaced();
+    }
+
+    // Places an order all-or-nothing; total is only set on success
+    bool placeOrder(int employeeID, const vector<OrderLine> &lines, double &total) {
+        ScopedLatency latency(ProbeOrderItems);
+        if (lines.empty()) {
+            return false;
+        }
+        for (size_t i = 0; i < lines.size(); ++i) {
+            if (lines[i].item >= count || lines[i].quantity <= 0 || !reserve(lines[i].item, lines[i].quantity)) {
+                for (size_t j = 0; j < i; ++j) {
+                    release(lines[j].item, lines[j].quantity);
+                }
+                return false;
+            }
+        }
+
+        double sum = 0.0;
+        for (const auto &line : lines) {
+            sum += line.quantity * slots[line.item].price;
+        }
+        total = sum;
+
+        if (orderJournal != nullptr) {
+            // Small orders build their record on the stack without touching the heap
+            alignas(OrderRecord::Line) byte scratch[16 * sizeof(OrderRecord::Line)];
+            pmr::monotonic_buffer_resource arena(scratch, sizeof(scratch));
+            OrderRecord record(&arena);
+            record.timestamp = chrono::duration_cast<chrono::seconds>(chrono::system_clock::now().time_since_epoch()).count();
+            record.employeeID = employeeID;
+            record.lines.reserve(lines.size());
+            for (const auto &line : lines) {
+                record.lines.push_back({static_cast<uint32_t>(line.item), line.quantity, slots[line.item].price});
+            }
+            record.writeTo(*orderJournal);
+        }
+        confirm(lines);
+        return true;
+    }
+
+    // Writes sold quantities that are not in the inventory log yet and folds
+    // in stock changes other processes logged since the last sync
+    void syncSales() {
+        if (store == nullptr) {
+            return;
+        }
+        lock_guard<mutex> lock(syncMtx); // Only concurrent syncs wait here, never reservations
+        vector<int> sold(count);
+        for (size_t i = 0; i < count; ++i) {
+            sold[i] = slots[i].unsynced.exchange(0, memory_order_acq_rel);
+        }
+        if (names.empty()) {
+            names.reserve(count);
+            for (size_t i = 0; i < count; ++i) {
+                names.push_back(slots[i].name);
+            }
+        }
+        if (!store->recordSales(names, sold, levels, seenLsn)) {
+            seenLsn = 0; // Some sales may not be logged; reread every level next time
+        }
+        for (size_t i = 0; i < count; ++i) {
+            slots[i].logged -= sold[i];
+            if (levels.empty()) {
+                continue; // Nobody else changed the inventory
+            }
+            int others = levels[i] - slots[i].logged;
+            if (others != 0) {
+                slots[i].stock.fetch_add(others, memory_order_acq_rel);
+            }
+            slots[i].logged = levels[i];
+        }
+    }
+
+private:
+    // Padded to a cache line so threads working on different items do not collide
+    struct alignas(64) Slot {
+        atomic<int> stock{0};
+        atomic<int> unsynced{0}; // Sold but not yet written to the inventory log
+        string name;
+        double price = 0.0;
+        int logged = 0; // Level in the inventory log after the last sync; guarded by syncMtx
+    };
+
+    size_t count;
+    unique_ptr<Slot[]> slots;
+    InventoryStore *store;
+    JournalWriter *orderJournal;
+    unsigned syncInterval;
+    atomic<unsigned> ordersSinceSync{0};
+    mutex syncMtx;
+    vector<string> names; // Item names and levels for recordSales(); guarded by syncMtx
+    vector<int> levels;
+    uint64_t seenLsn = 0; // Inventory log position after our last sync; 0 rereads every level
+
+    void orderPlaced() {
+        if (store == nullptr || ordersSinceSync.fetch_add(1, memory_order_relaxed) + 1 < syncInterval) {
+            return;
+        }
+        ordersSinceSync.store(0, memory_order_relaxed);
+        syncSales();
+    }
+};
+
+// Renders rows of cells as an aligned text table or as CSV, TSV or JSON.
+// Cells are appended to one buffer as they are added (numbers through
+// to_chars) and column widths are tracked at the same time, so rendering is
+// a single pass into a reusable output buffer that is written out in large
+// blocks rather than flushed per row.
+class TableWriter {
+public:
+    enum class Format { Text, Csv, Tsv, Json };
+
+    explicit TableWriter(vector<string> headers, size_t minWidth = 10) {
+        for (auto &header : headers) {
+            size_t width = max(minWidth, header.size() + 1);
+            columns.push_back({move(header), string(), width, false});
+        }
+    }
+
+    // Parses "table", "csv", "tsv" or "json"
+    static bool parseFormat(string_view name, Format &format) {
+        const pair<string_view, Format> names[] = {
+            {"table", Format::Text}, {"csv", Format::Csv}, {"tsv", Format::Tsv}, {"json", Format::Json}};
+        for (const auto &entry : names) {
+            if (entry.first == name) {
+                format = entry.second;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // Text shown before every cell of a column in the aligned table only, such as "$".
+    // Set it before adding rows.
+    void setPrefix(size_t column, string prefix) {
+        columns[column].width = max(columns[column].width, prefix.size() + 1);
+        columns[column].prefix = move(prefix);
+    }
+
+    // Cells fill rows left to right
+    TableWriter &add(string_view text) { return addCell(text, false); }
+
+    template <typename Number, typename = enable_if_t<is_arithmetic_v<Number>>>
+    TableWriter &add(Number value) {
+        char digits[32];
+        auto result = to_chars(digits, digits + sizeof(digits), value);
+        return addCell(string_view(digits, static_cast<size_t>(result.ptr - digits)), true);
+    }
+
+    size_t rows() const { return ends.size() / columns.size(); }
+
+    // Writes count rows starting at row first
+    void render(ostream &out, Format format, size_t first = 0, size_t count = SIZE_MAX) const {
+        size_t last = first + min(count, rows() > first ? rows() - first : 0);
+        buffer.clear();
+        if (format == Format::Text) {
+            buffer += '\n';
+            appendRule();
+            for (size_t c = 0; c < columns.size(); ++c) {
+                appendPadded(columns[c].header, columns[c].width, c + 1 == columns.size());
+            }
+            buffer += '\n';
+            appendRule();
+        } else if (format == Format::Json) {
+            buffer += '[';
+        } else {
+            char separator = format == Format::Csv ? ',' : '\t';
+            for (size_t c = 0; c < columns.size(); ++c) {
+                if (c > 0) {
+                    buffer += separator;
+                }
+                appendEscaped(columns[c].header, format);
+            }
+            buffer += '\n';
+        }
+
+        for (size_t r = first; r < last; ++r) {
+            if (format == Format::Text) {
+                for (size_t c = 0; c < columns.size(); ++c) {
+                    size_t start = buffer.size();
+                    buffer += columns[c].prefix;
+                    buffer.append(cell(r, c));
+                    padTo(start + columns[c].width, c + 1 == columns.size());
+                }
+            } else if (format == Format::Json) {
+                buffer += r == first ? "\n  {" : ",\n  {";
+                for (size_t c = 0; c < columns.size(); ++c) {
+                    buffer += c == 0 ? "\"" : ", \"";
+                    appendEscaped(columns[c].header, format);
+                    buffer += "\": ";
+                    if (columns[c].numeric) {
+                        buffer.append(cell(r, c));
+                    } else {
+                        buffer += '"';
+                        appendEscaped(cell(r, c), format);
+                        buffer += '"';
+                    }
+                }
+                buffer += '}';
+            } else {
+                for (size_t c = 0; c < columns.size(); ++c) {
+                    if (c > 0) {
+                        buffer += format == Format::Csv ? ',' : '\t';
+                    }
+                    appendEscaped(cell(r, c), format);
+                }
+            }
+            if (format != Format::Json) {
+                buffer += '\n';
+            }
+            if (buffer.size() >= flushBytes) {
+                out.write(buffer.data(), static_cast<streamsize>(buffer.size()));
+                buffer.clear();
+            }
+        }
+
+        if (format == Format::Text) {
+            appendRule();
+        } else if (format == Format::Json) {
+            buffer += last > first ? "\n]\n" : "]\n";
+        }
+        out.write(buffer.data(), static_cast<streamsize>(buffer.size()));
+    }
+
+    // Shows the aligned table a page at a time, asking before each further page
+    void page(ostream &out, istream &in, size_t pageSize) const {
+        size_t pages = max<size_t>(1, (rows() + pageSize - 1) / pageSize);
+        for (size_t p = 0; p < pages; ++p) {
+            render(out, Format::Text, p * pageSize, pageSize);
+            if (p + 1 < pages) {
+                out << "Page " << p + 1 << " of " << pages << ". Enter n for the next page or anything else to stop: ";
+                string answer;
+                if (!(in >> answer) || (answer != "n" && answer != "N")) {
+                    break;
+                }
+            }
+        }
+    }
+
+private:
+    static bool needsEscape(char c, Format format) {
+        switch (format) {
+        case Format::Csv:
+            return c == ',' || c == '"' || c == '\r' || c == '\n';
+        case Format::Tsv:
+            return c == '\t' || c == '\r' || c == '\n';
+        default:
+            return c == '"' || c == '\\' || static_cast<unsigned char>(c) < 0x20;
+        }
+    }
+
+    struct Column {
+        string header;
+        string prefix;
+        size_t width; // Widest cell plus one space
+        bool numeric; // Written unquoted in JSON
+    };
+
+    static constexpr size_t flushBytes = 64 * 1024;
+
+    vector<Column> columns;
+    string text;          // Every cell back to back
+    vector<size_t> ends;  // End of each cell in text, row by row
+    mutable string buffer; // Output being rendered
+
+    TableWriter &addCell(string_view value, bool numeric) {
+        Column &column = columns[ends.size() % columns.size()];
+        column.width = max(column.width, column.prefix.size() + value.size() + 1);
+        column.numeric = numeric;
+        text.append(value);
+        ends.push_back(text.size());
+        return *this;
+    }
+
+    string_view cell(size_t row, size_t column) const {
+        size_t index = row * columns.size() + column;
+        size_t start = index == 0 ? 0 : ends[index - 1];
+        return string_view(text).substr(start, ends[index] - start);
+    }
+
+    void appendRule() const {
+        size_t width = 0;
+        for (const auto &column : columns) {
+            width += column.width;
+        }
+        buffer.append(max<size_t>(width - 1, 45), '=');
+        buffer += '\n';
+    }
+
+    // The last column is not padded, so lines carry no trailing spaces
+    void appendPadded(string_view value, size_t width, bool lastColumn) const {
+        size_t start = buffer.size();
+        buffer.append(value);
+        padTo(start + width, lastColumn);
+    }
+
+    void padTo(size_t end, bool lastColumn) const {
+        if (!lastColumn && buffer.size() < end) {
+            buffer.append(end - buffer.size(), ' ');
+        }
+    }
+
+    // Most cells need no escaping, so they are checked first and appended whole
+    void appendEscaped(string_view value, Format format) const {
+        if (none_of(value.begin(), value.end(), [format](char c) { return needsEscape(c, format); })) {
+            buffer.append(value);
+            return;
+        }
+        if (format == Format::Csv) {
+            buffer += '"';
+            for (char c : value) {
+                buffer += c;
+                if (c == '"') {
+                    buffer += '"';
+                }
+            }
+            buffer += '"';
+        } else if (format == Format::Tsv) {
+            for (char c : value) {
+                buffer += c == '\t' || c == '\n' || c == '\r' ? ' ' : c;
+            }
+        } else {
+            for (char c : value) {
+                if (c == '"' || c == '\\') {
+                    buffer += '\\';
+                    buffer += c;
+                } else if (static_cast<unsigned char>(c) < 0x20) {
+                    char escape[8];
+                    snprintf(escape, sizeof(escape), "\\u%04x", c);
+                    buffer += escape;
+                } else {
+                    buffer += c;
+                }
+            }
+        }
+    }
+};
+
+// Copies employees from employee_details.csv (name,age,id,salary), which earlier
+// versions appended to, into a newly created registry
+void EmployeeRegistry::importCsv(const string &csvPath) {
+    CsvReader reader(csvPath);
+    if (!reader.isOpen()) {
+        return; // No employees saved yet
+    }
+
+    vector<string_view> fields;
+    size_t imported = 0;
+    while (reader.nextRow(fields)) {
+        EmployeeStore::EmployeeData emp;
+        if (fields.size() != 4) {
+            reader.malformed("expected 4 fields");
+        } else if (!CsvReader::parseInt(fields[1], emp.age) || !CsvReader::parseInt(fields[2], emp.empID)) {
+            reader.malformed("bad age or ID");
+        } else if (!CsvReader::parseDouble(fields[3], emp.salary)) {
+            reader.malformed("bad salary");
+        } else if (fields[0].size() > EmployeeRegistry::maxNameBytes) {
+            reader.malformed("name too long");
+        } else {
+            emp.name.assign(fields[0]);
+            imported += writeSlot(emp) ? 1 : 0;
+        }
+    }
+    reportCsvErrors(csvPath, reader);
+    if (imported > 0) {
+        publishChange();
+        cout << "Imported " << imported << " employees from " << csvPath << ".\n";
+    }
+}
+
+// Base class Person
+class Person {
+protected:
+    string name;
+    int id;
+    string password;
+
+public:
+    Person(string n, int i, string pass) : name(n), id(i), password(pass) {}
+    Person(string n, string pass) : name(n), password(pass) {}  // Corrected constructor for Admin
+    virtual void displayMenu() = 0; // Pure virtual function
+};
+
+// Derived class Admin
+class Admin : public Person {
+private:
+    using EmployeeData = EmployeeStore::EmployeeData;
+
+    EmployeeStore employeeData;
+    static constexpr size_t pageSize = 20; // Table rows shown before asking for the next page
+
+    // Helper function to write inventory to file
+    void writeToFile(const InventoryItem &item) {
+        if (!InventoryStore::instance().addStock(item.itemName, item.quantity, item.price)) {
+            cout << "Unable to open inventory file for writing.\n";
+        }
+    }
+
+    // Saves a new or edited employee in place in the registry
+    void writeEmployeeToFile(const EmployeeData &emp) {
+        if (!EmployeeRegistry::instance().put(emp)) {
+            cout << "Unable to save employee " << emp.name << ".\n";
+        }
+    }
+
+    // Load employees saved by earlier sessions
+    void readEmployeesFromFile() {
+        vector<EmployeeData> saved = EmployeeRegistry::instance().employees();
+        employeeData.reserve(saved.size());
+        for (const auto &emp : saved) {
+            employeeData.insert(emp);
+        }
+    }
+
+public:
+    Admin(string n, string pass) : Person(n, pass) {
+        readEmployeesFromFile();
+    }
+
+    void addEmployee() {
+        EmployeeData newEmp;
+        cout << "Enter Employee Name: ";
+        cin >> newEmp.name;
+
+        if (newEmp.name.size() > EmployeeRegistry::maxNameBytes) {
+            cout << "Name is too long (at most " << EmployeeRegistry::maxNameBytes << " characters).\n";
+            return;
+        }
+
+        // Check if the name already exists
+        if (employeeData.findByName(newEmp.name)) {
+            cout << "Employee with this name already exists. Please enter a different name.\n";
+            return;
+        }
+
+        // Age validation
+        do {
+            cout << "Enter Employee Age (should not exceed 85): ";
+            cin >> newEmp.age;
+            if (newEmp.age > 85) {
+                cout << "Invalid age. Age cannot be greater than 85. Please re-enter.\n";
+            }
+        } while (newEmp.age > 85);
+
+        cout << "Enter Employee ID: ";
+        cin >> newEmp.empID;
+
+        // Check if the ID already exists
+        if (employeeData.findByID(newEmp.empID)) {
+            cout << "Employee with this ID already exists. Please enter a different ID.\n";
+            return;
+        }
+
+        cout << "Enter Employee Salary: ";
+        cin >> newEmp.salary;
+
+        employeeData.insert(newEmp);
+        writeEmployeeToFile(newEmp);
+
+        cout << "Employee added successfully!\n";
+    }
+
+    void deleteEmployee() {
+        int choice;
+        cout << "Delete Employee by:\n1. Name\n2. ID\nEnter choice: ";
+        cin >> choice;
+
+        string empName;
+        int empID;
+        bool found = false;
+
+        if (choice == 1) {
+            cout << "Enter Employee Name to delete: ";
+            cin >> empName;
+            const EmployeeData *emp = employeeData.findByName(empName);
+            if (emp != nullptr) {
+                EmployeeRegistry::instance().remove(emp->empID);
+                employeeData.eraseByName(empName);
+                cout << "Employee " << empName << " deleted successfully!\n";
+                found = true;
+            }
+        } else if (choice == 2) {
+            cout << "Enter Employee ID to delete: ";
+            cin >> empID;
+            if (employeeData.eraseByID(empID)) {
+                EmployeeRegistry::instance().remove(empID);
+                cout << "Employee with ID " << empID << " deleted successfully!\n";
+                found = true;
+            }
+        } else {
+            cout << "Invalid option!\n";
+        }
+
+        if (!found) {
+            cout << "Employee not found.\n";
+        }
+    }
+
+    void editEmployee() {
+        int empID;
+        cout << "Enter Employee ID to edit: ";
+        cin >> empID;
+
+        EmployeeData *emp = employeeData.findByID(empID);
+        if (emp == nullptr) {
+            cout << "Employee not found.\n";
+            return;
+        }
+
+        string newName;
+        cout << "Editing Employee: " << emp->name << "\n";
+        cout << "Enter new name: ";
+        cin >> newName;
+        if (newName.size() > EmployeeRegistry::maxNameBytes) {
+            cout << "Name is too long (at most " << EmployeeRegistry::maxNameBytes << " characters).\n";
+            return;
+        }
+        if (!employeeData.rename(empID, newName)) {
+            cout << "Employee with this name already exists. Please enter a different name.\n";
+            return;
+        }
+        cout << "Enter new age: ";
+        cin >> emp->age;
+        cout << "Enter new salary: ";
+        cin >> emp->salary;
+        writeEmployeeToFile(*emp);
+        cout << "Employee details updated successfully!\n";
+    }
+
+    void viewEmployees() {
+        if (employeeData.empty()) {
+            cout << "No employees to display.\n";
+            return;
+        }
+
+        employeeTable().page(cout, cin, pageSize);
+    }
+
+    // Columns grow to fit the longest name, so long names no longer shift the row
+    TableWriter employeeTable() const {
+        TableWriter table({"Name", "Age", "ID", "Salary"});
+        table.setPrefix(3, "$");
+        for (const auto &emp : employeeData) {
+            table.add(emp.name).add(emp.age).add(emp.empID).add(emp.salary);
+        }
+        return table;
+    }
+
+    void addItemToInventory() {
+        InventoryItem newItem;
+        cout << "Enter item name: ";
+        cin >> newItem.itemName;
+        cout << "Enter quantity: ";
+        cin >> newItem.quantity;
+        cout << "Enter price: ";
+        cin >> newItem.price;
+
+        // Write the new item to the CSV file
+        writeToFile(newItem);
+
+        cout << "Item added to inventory successfully!\n";
+    }
+
+    void viewInventory() {
+        TableWriter table = inventoryTable();
+        if (table.rows() > 0) {
+            table.page(cout, cin, pageSize);
+        } else {
+            cout << "Inventory is empty.\n";
+        }
+    }
+
+    static TableWriter inventoryTable() {
+        InventoryStore::Snapshot snapshot = InventoryStore::instance().items();
+        TableWriter table({"Item Name", "Quantity", "Price"});
+        table.setPrefix(2, "$");
+        for (const auto &item : *snapshot) {
+            table.add(item.itemName).add(item.quantity).add(item.price);
+        }
+        return table;
+    }
+
+    // Low-stock listing, stock value and value per category over the whole inventory
+    void inventoryReports() {
+        int choice;
+        cout << "\nInventory Reports:\n1. Low Stock\n2. Total Stock Value\n3. Stock Value by Category\n"
+             << "4. Set Reorder Level and Category\nEnter choice: ";
+        cin >> choice;
+
+        InventoryStore &store = InventoryStore::instance();
+        if (choice == 4) {
+            string itemName, category;
+            int reorderLevel;
+            cout << "Enter item name: ";
+            cin >> itemName;
+            cout << "Enter reorder level: ";
+            cin >> reorderLevel;
+            cout << "Enter category: ";
+            cin >> category;
+            if (store.setItemSettings(itemName, reorderLevel, category)) {
+                cout << "Reorder level and category saved.\n";
+            } else {
+                cout << "Unable to write the inventory settings file.\n";
+            }
+            return;
+        }
+
+        shared_ptr<const InventoryColumns> columns = store.columns();
+        cout << fixed << setprecision(2);
+        if (choice == 1) {
+            vector<uint32_t> low;
+            lowStockItems(*columns, low);
+            if (low.empty()) {
+                cout << "No items are below their reorder level.\n";
+            } else {
+                cout << "\n=============================================\n";
+                cout << setw(15) << left << "Item Name" << setw(10) << "Quantity" << setw(10) << "Reorder" << endl;
+                cout << "=============================================\n";
+                for (uint32_t item : low) {
+                    cout << setw(15) << left << (*columns->items)[item].itemName
+                         << setw(10) << columns->quantities[item]
+                         << setw(10) << columns->reorderLevels[item] << endl;
+                }
+                cout << "=============================================\n";
+            }
+        } else if (choice == 2) {
+            cout << "Total stock value: $" << stockValue(*columns) << "\n";
+        } else if (choice == 3) {
+            vector<double> values = categoryValues(*columns);
+            cout << "\n=============================================\n";
+            cout << setw(20) << left << "Category" << "Value" << endl;
+            cout << "=============================================\n";
+            for (size_t i = 0; i < values.size(); ++i) {
+                cout << setw(20) << left << columns->categoryNames[i] << "$" << values[i] << endl;
+            }
+            cout << "=============================================\n";
+        } else {
+            cout << "Invalid option!\n";
+        }
+        cout.unsetf(ios::floatfield);
+        cout << setprecision(6);
+    }
+
+    // Shows the most recent orders from orders.csv with item names from the inventory
+    void viewOrders() {
+        // Orders this process still has queued or buffered are read back too
+        JournalWriter &journal = JournalWriter::forFile("orders.csv");
+        AsyncJournal::instance().drain();
+        journal.flush();
+
+        OrderLog log;
+        if (!loadOrders("orders.csv", log) || log.records.empty()) {
+            cout << "No orders to display.\n";
+            return;
+        }
+        InventoryStore::Snapshot snapshot = InventoryStore::instance().items();
+        const vector<InventoryItem> &inventory = *snapshot;
+
+        const size_t shown = min<size_t>(log.records.size(), 20);
+        cout << "\n=============================================\n";
+        cout << "Last " << shown << " of " << log.records.size() << " orders\n";
+        cout << "=============================================\n";
+        for (size_t i = log.records.size() - shown; i < log.records.size(); ++i) {
+            const OrderRecord &order = log.records[i];
+            time_t placed = static_cast<time_t>(order.timestamp);
+            char when[32];
+            strftime(when, sizeof(when), "%Y-%m-%d %H:%M:%S", localtime(&placed));
+            cout << when << "  Employee " << order.employeeID << "  $" << order.total() << "\n";
+            for (const auto &line : order.lines) {
+                cout << "    " << itemNameOf(inventory, line.itemID) << " (x" << line.quantity << ") at $"
+                     << line.unitPrice << "\n";
+            }
+        }
+        cout << "=============================================\n";
+        if (log.legacyRows > 0) {
+            cout << log.legacyRows << " older free-text orders are not shown.\n";
+        }
+    }
+
+    // Best sellers, revenue per employee and sales by hour and day over the whole
+    // order history, from the running sales summary
+    void salesAnalytics() {
+        // Flushing the orders journal brings the summary up to date
+        JournalWriter &journal = JournalWriter::forFile("orders.csv");
+        SalesSummary &summary = SalesSummary::instance();
+        AsyncJournal::instance().drain();
+        journal.flush();
+
+        SalesReport report = summary.totals();
+        if (report.overall.orders == 0) {
+            cout << "No orders to analyse.\n";
+            return;
+        }
+
+        InventoryStore::Snapshot snapshot = InventoryStore::instance().items();
+        const vector<InventoryItem> &inventory = *snapshot;
+
+        cout << "\n" << report.overall.orders << " orders, " << report.overall.quantity << " items sold, $"
+             << SalesReport::formatCents(report.overall.revenueCents) << " revenue\n";
+
+        for (bool byRevenue : {false, true}) {
+            cout << "\nTop 10 items by " << (byRevenue ? "revenue" : "quantity") << ":";
+            TableWriter table({"Item Name", "Quantity", "Revenue"});
+            table.setPrefix(2, "$");
+            for (const auto &ranked : report.topItems(10, byRevenue)) {
+                table.add(itemNameOf(inventory, ranked.item)).add(ranked.totals.quantity)
+                     .add(SalesReport::formatCents(ranked.totals.revenueCents));
+            }
+            table.render(cout, TableWriter::Format::Text);
+        }
+
+        cout << "\nSales by hour:";
+        TableWriter hours({"Hour", "Orders", "Items", "Revenue"});
+        hours.setPrefix(3, "$");
+        for (int hour = 0; hour < 24; ++hour) {
+            const SalesReport::Totals &totals = report.hours[hour];
+            if (totals.orders > 0) {
+                char label[8];
+                snprintf(label, sizeof(label), "%02d:00", hour);
+                hours.add(label).add(totals.orders).add(totals.quantity).add(SalesReport::formatCents(totals.revenueCents));
+            }
+        }
+        hours.render(cout, TableWriter::Format::Text);
+
+        const size_t recentDays = 14;
+        vector<pair<int, SalesReport::Totals>> days(report.days.begin(), report.days.end());
+        sort(days.begin(), days.end(), [](const auto &a, const auto &b) { return a.first < b.first; });
+        days.erase(days.begin(), days.end() - min(days.size(), recentDays));
+        cout << "\nSales on the last " << days.size() << " days with orders:";
+        TableWriter perDay({"Date", "Orders", "Items", "Revenue"});
+        perDay.setPrefix(3, "$");
+        for (const auto &entry : days) {
+            char date[16];
+            snprintf(date, sizeof(date), "%04d-%02d-%02d", entry.first / 10000, entry.first / 100 % 100, entry.first % 100);
+            perDay.add(date).add(entry.second.orders).add(entry.second.quantity)
+                  .add(SalesReport::formatCents(entry.second.revenueCents));
+        }
+        perDay.render(cout, TableWriter::Format::Text);
+
+        vector<pair<int, SalesReport::Totals>> employees(report.employees.begin(), report.employees.end());
+        sort(employees.begin(), employees.end(), [](const auto &a, const auto &b) {
+            return a.second.revenueCents != b.second.revenueCents ? a.second.revenueCents > b.second.revenueCents
+                                                                  : a.first < b.first;
+        });
+        cout << "\nRevenue per employee:";
+        TableWriter perEmployee({"Employee ID", "Orders", "Items", "Revenue"});
+        perEmployee.setPrefix(3, "$");
+        for (const auto &entry : employees) {
+            perEmployee.add(entry.first).add(entry.second.orders).add(entry.second.quantity)
+                       .add(SalesReport::formatCents(entry.second.revenueCents));
+        }
+        perEmployee.page(cout, cin, pageSize);
+
+        if (report.legacyRows > 0) {
+            cout << report.legacyRows << " older free-text orders are not included.\n";
+        }
+    }
+
+    void displayMenu() override {
+        int choice;
+        do {
+            cout << "\nAdmin Menu:\n1. Add Employee\n2. Delete Employee\n3. Edit Employee\n4. View Employees\n"
+                 << "5. Add Inventory Item\n6. View Inventory\n7. View Stats\n8. View Orders\n9. Inventory Reports\n"
+                 << "10. Sales Analytics\n11. Logout\n";
+            cin >> choice;
+            switch (choice) {
+                case 1: addEmployee(); break;
+                case 2: deleteEmployee(); break;
+                case 3: editEmployee(); break;
+                case 4: viewEmployees(); break;
+                case 5: addItemToInventory(); break;
+                case 6: viewInventory(); break;
+                case 7: Stats::dump(cout); break;
+                case 8: viewOrders(); break;
+                case 9: inventoryReports(); break;
+                case 10: salesAnalytics(); break;
+                case 11: cout << "Logging out of Admin Menu.\n"; break;
+                default: cout << "Invalid option!\n";
+            }
+        } while (choice != 11);
+    }
+};
+
+// Derived class Employee
+class Employee : public Person {
+private:
+    pmr::monotonic_buffer_resource sessionArena; // Order lines for this login, freed at logout
+
+    // Queues the order for the background writer; the latency probe covers only the hand-off
+    void writeOrderToFile(const OrderRecord &order) {
+        ScopedLatency latency(ProbeWriteOrderToFile);
+        JournalWriter &journal = JournalWriter::forFile("orders.csv");
+        if (!journal.isOpen()) {
+            cout << "Unable to open orders file for writing.\n";
+            return;
+        }
+        string row;
+        order.format(row);
+        if (!AsyncJournal::instance().submit(journal, move(row))) {
+            cout << "Order could not be saved: the writer queue is full.\n";
+        }
+    }
+
+    // Resolves typed text to an item ID, asking the user to choose when it is
+    // ambiguous; returns -1 if nothing was chosen
+    int pickItem(const ItemSearchIndex &search, const vector<InventoryItem> &inventory, const string &query) {
+        const size_t maxMatches = 10;
+        vector<ItemSearchIndex::Match> matches = search.prefix(query, maxMatches);
+        if (matches.size() == 1 ||
+            (!matches.empty() && EmployeeStore::foldCase(inventory[matches[0].item].itemName) == EmployeeStore::foldCase(query))) {
+            cout << "Selected: " << inventory[matches[0].item].itemName << "\n";
+            return static_cast<int>(matches[0].item);
+        }
+        if (matches.empty()) {
+            matches = search.fuzzy(query, maxMatches);
+            if (matches.empty()) {
+                cout << "No items match \"" << query << "\". Please try again.\n";
+                return -1;
+            }
+            cout << "No items start with \"" << query << "\". Did you mean:\n";
+        } else {
+            cout << "Matching items:\n";
+        }
+
+        for (size_t i = 0; i < matches.size(); ++i) {
+            const InventoryItem &item = inventory[matches[i].item];
+            cout << i + 1 << ". " << item.itemName << " (Price: $" << item.price
+                 << ", Available Quantity: " << item.quantity << ")\n";
+        }
+        cout << "Enter choice (0 to search again): ";
+        size_t choice = 0;
+        cin >> choice;
+        return choice >= 1 && choice <= matches.size() ? static_cast<int>(matches[choice - 1].item) : -1;
+    }
+
+public:
+    Employee(string n, int i, string pass) : Person(n, i, pass) {}
+
+    // The process's order engine, synced with the inventory log. It is rebuilt
+    // when the item list changes; search is set to the index its item IDs match.
+    static shared_ptr<OrderEngine> orderEngine(shared_ptr<const ItemSearchIndex> &search) {
+        InventoryStore &store = InventoryStore::instance();
+        static shared_ptr<OrderEngine> engine; // Declared after the store so it is destroyed first
+        if (engine) {
+            engine->syncSales(); // Picks up stock changed by other processes
+        }
+        search = store.searchIndex();
+        if (!engine || !engine->sells(*search->snapshot())) {
+            engine.reset(); // Its destructor logs anything still unsynced
+            search = store.searchIndex();
+            engine = make_shared<OrderEngine>(*search->snapshot(), &store, nullptr, 1);
+        }
+        return engine;
+    }
+
+    void orderItems() {
+        shared_ptr<const ItemSearchIndex> search;
+        shared_ptr<OrderEngine> engine = orderEngine(search);
+        vector<InventoryItem> inventory = *search->snapshot(); // Local copy to show stock left during this order
+        for (size_t i = 0; i < inventory.size(); ++i) {
+            inventory[i].quantity = engine->stock(i);
+        }
+
+        if (inventory.empty()) {
+            cout << "Inventory is empty.\n";
+            return;
+        }
+
+        OrderRecord order(&sessionArena);
+        order.employeeID = id;
+        vector<OrderEngine::OrderLine> taken;
+        string query;
+        int quantity;
+
+        for (;;) {
+            cout << "\nEnter item name or its first letters (0 to finish): ";
+            if (!(cin >> query) || query == "0") {
+                break;
+            }
+
+            int itemID = pickItem(*search, inventory, query);
+            if (itemID < 0) {
+                continue;
+            }
+
+            cout << "Enter quantity: ";
+            cin >> quantity;
+
+            InventoryItem &selectedItem = inventory[itemID];
+
+            bool reserved = false;
+            if (quantity > 0) {
+                ScopedLatency latency(ProbeOrderItems); // Time the stock check, not the prompts
+                reserved = engine->reserve(static_cast<size_t>(itemID), quantity);
+            }
+
+            if (quantity <= 0) {
+                cout << "Invalid quantity. Please try again.\n";
+            } else if (reserved) {
+                selectedItem.quantity = engine->stock(static_cast<size_t>(itemID));
+                taken.push_back({static_cast<size_t>(itemID), quantity});
+                order.lines.push_back({static_cast<uint32_t>(itemID), quantity, selectedItem.price}); // Stable item ID
+            } else {
+                cout << "Insufficient stock. Please try again.\n";
+            }
+        }
+
+        if (!order.lines.empty()) {
+            engine->confirm(taken); // Logs the stock taken
+            order.timestamp = chrono::duration_cast<chrono::seconds>(chrono::system_clock::now().time_since_epoch()).count();
+            writeOrderToFile(order);
+
+            cout << "Order placed successfully!\n";
+            cout << "Items Ordered: ";
+            for (size_t i = 0; i < order.lines.size(); ++i) {
+                cout << (i > 0 ? ", " : "") << inventory[order.lines[i].itemID].itemName
+                     << " (x" << order.lines[i].quantity << ")";
+            }
+            cout << endl;
+            cout << "Total Amount: $" << order.total() << endl;
+        } else {
+            cout << "No items were ordered.\n";
+        }
+    }
+
+    void displayMenu() override {
+        int choice;
+        do {
+            cout << "\nEmployee Menu:\n1. Order Items\n2. Logout\n";
+            cin >> choice;
+            switch (choice) {
+                case 1: orderItems(); break;
+                case 2: cout << "Logging out of Employee Menu.\n"; break;
+                default: cout << "Invalid option!\n";
+            }
+        } while (choice != 2);
+    }
+};
+
+// Discards everything written to it
+class NullBuffer : public streambuf {
+protected:
+    int overflow(int c) override { return traits_type::not_eof(c); }
+    streamsize xsputn(const char *, streamsize n) override { return n; }
+};
+
+// Replays scripted console input through the real Admin and Employee methods
+// and reports latency per operation as CSV:
+// variant,operation,records,calls,p50_us,p99_us,ops_per_sec
+class OpsBenchmark {
+public:
+    OpsBenchmark(string variant, size_t records) : variant(move(variant)), records(records) {}
+
+    // Feeds input to cin for one call of fn and records how long the call took
+    template <typename Fn>
+    void replay(const string &operation, const string &input, Fn fn) {
+        istringstream in(input);
+        streambuf *console = cin.rdbuf(in.rdbuf());
+        auto start = chrono::steady_clock::now();
+        fn();
+        double us = chrono::duration<double, micro>(chrono::steady_clock::now() - start).count();
+        cin.rdbuf(console);
+        samplesFor(operation).push_back(us);
+    }
+
+    void report(ostream &out) {
+        out << "variant,operation,records,calls,p50_us,p99_us,ops_per_sec\n";
+        for (auto &entry : samples) {
+            vector<double> &us = entry.second;
+            sort(us.begin(), us.end());
+            double total = 0.0;
+            for (double sample : us) {
+                total += sample;
+            }
+            out << variant << "," << entry.first << "," << records << "," << us.size() << ","
+                << fixed << setprecision(3) << us[us.size() / 2] << "," << us[us.size() * 99 / 100] << ","
+                << setprecision(0) << (total > 0 ? us.size() * 1e6 / total : 0.0) << "\n";
+        }
+    }
+
+private:
+    string variant;
+    size_t records;
+    vector<pair<string, vector<double>>> samples; // In the order operations were first run
+
+    vector<double> &samplesFor(const string &operation) {
+        for (auto &entry : samples) {
+            if (entry.first == operation) {
+                return entry.second;
+            }
+        }
+        samples.emplace_back(operation, vector<double>());
+        return samples.back().second;
+    }
+};
+
+// Throughput benchmark for EmployeeStore insert/lookup/delete
+void benchEmployeeStore() {
+    using Clock = chrono::steady_clock;
+    const size_t sizes[] = {10000, 100000, 1000000};
+
+    cout << setw(10) << left << "Records" << setw(16) << "Insert ops/s"
+         << setw(16) << "Lookup ops/s" << setw(16) << "Delete ops/s" << "\n";
+    for (size_t n : sizes) {
+        EmployeeStore store;
+        store.reserve(n);
+
+        auto start = Clock::now();
+        for (size_t i = 0; i < n; ++i) {
+            store.insert({"Emp" + to_string(i), 30, static_cast<int>(i), 1000.0});
+        }
+        double insertSec = chrono::duration<double>(Clock::now() - start).count();
+
+        size_t hits = 0;
+        start = Clock::now();
+        for (size_t i = 0; i < n; ++i) {
+            hits += store.findByID(static_cast<int>(i)) != nullptr;
+            hits += store.findByName("EMP" + to_string(i)) != nullptr;
+        }
+        double lookupSec = chrono::duration<double>(Clock::now() - start).count();
+
+        start = Clock::now();
+        for (size_t i = 0; i < n; ++i) {
+            store.eraseByID(static_cast<int>(i));
+        }
+        double deleteSec = chrono::duration<double>(Clock::now() - start).count();
+
+        if (hits != 2 * n || !store.empty()) {
+            cout << "Benchmark self-check failed.\n";
+            return;
+        }
+        cout << setw(10) << left << n << setw(16) << static_cast<long long>(n / insertSec)
+             << setw(16) << static_cast<long long>(2 * n / lookupSec)
+             << setw(16) << static_cast<long long>(n / deleteSec) << "\n";
+    }
+}
+
+// Parse time for an N-row inv.csv: CsvReader against the old getline/substr/stoi path
+void benchCsvParse(size_t rows) {
+    using Clock = chrono::steady_clock;
+    const string path = "bench_inv.csv";
+    {
+        ofstream outFile(path);
+        for (size_t i = 0; i < rows; ++i) {
+            outFile << "Item" << i % 1000 << "," << i % 500 << "," << (i % 100) * 0.25 << "\n";
+        }
+    }
+
+    auto start = Clock::now();
+    vector<InventoryItem> oldItems;
+    ifstream inFile(path);
+    string line;
+    while (getline(inFile, line)) {
+        size_t pos1 = line.find(",");
+        size_t pos2 = line.find(",", pos1 + 1);
+        if (pos1 == string::npos || pos2 == string::npos) {
+            continue;
+        }
+        oldItems.push_back({line.substr(0, pos1), stoi(line.substr(pos1 + 1, pos2 - pos1 - 1)),
+                            stod(line.substr(pos2 + 1))});
+    }
+    double oldSec = chrono::duration<double>(Clock::now() - start).count();
+
+    start = Clock::now();
+    vector<InventoryItem> newItems = loadInventoryCsv(path);
+    double newSec = chrono::duration<double>(Clock::now() - start).count();
+    remove(path.c_str());
+
+    if (oldItems.size() != rows || newItems.size() != rows) {
+        cout << "Benchmark self-check failed.\n";
+        return;
+    }
+    cout << setw(12) << left << "Rows" << setw(16) << "getline s" << setw(16) << "CsvReader s"
+         << setw(16) << "Speedup" << "\n";
+    cout << fixed << setprecision(3) << setw(12) << left << rows << setw(16) << oldSec
+         << setw(16) << newSec << setw(16) << oldSec / newSec << "\n";
+}
+
+// Records/s for the old open/append/close path and each JournalWriter durability mode
+void benchJournal() {
+    using Clock = chrono::steady_clock;
+    using Durability = JournalWriter::Durability;
+    const string path = "bench_orders.csv";
+    const string record = "1760000000,7,2,0,2,1.5,3,1,1.5";
+
+    auto report = [](const string &mode, int records, Clock::time_point start) {
+        double sec = chrono::duration<double>(Clock::now() - start).count();
+        cout << setw(20) << left << mode << setw(12) << records << static_cast<long long>(records / sec) << "\n";
+    };
+
+    cout << setw(20) << left << "Mode" << setw(12) << "Records" << "Records/s" << "\n";
+    int records = 100000;
+    auto start = Clock::now();
+    for (int i = 0; i < records; ++i) {
+        ofstream outFile(path, ios::app);
+        outFile << record << endl;
+    }
+    report("ofstream per record", records, start);
+    remove(path.c_str());
+
+    const pair<Durability, string> modes[] = {
+        {Durability::None, "journal none"}, {Durability::Flush, "journal flush"}, {Durability::Fdatasync, "journal fdatasync"}};
+    for (const auto &mode : modes) {
+        records = mode.first == Durability::Fdatasync ? 2000 : 1000000;
+        start = Clock::now();
+        {
+            JournalWriter journal(path, mode.first);
+            for (int i = 0; i < records; ++i) {
+                journal.append(record);
+                journal.commit();
+            }
+        }
+        report(mode.second, records, start);
+        remove(path.c_str());
+    }
+}
+
+// Item lookup at several inventory sizes: printing the whole list (the old
+// picker), a linear scan for a prefix, and ItemSearchIndex prefix and
+// misspelled-name lookups, top 10 each. Times are per lookup.
+void benchItemSearch() {
+    using Clock = chrono::steady_clock;
+    const string words[] = {"masala", "paneer", "chicken", "veg", "butter", "garlic", "mango", "lemon",
+                            "ginger", "cheese", "tomato", "onion", "spicy", "sweet", "plain", "crispy"};
+    const string dishes[] = {"dosa", "naan", "rice", "curry", "lassi", "tea", "samosa", "roll",
+                             "biryani", "soup", "salad", "noodles", "pulao", "idli", "vada", "paratha"};
+    const size_t sizes[] = {1000, 10000, 100000};
+    const int lookups = 2000;
+    NullBuffer nullBuffer;
+    ostream discard(&nullBuffer);
+
+    cout << setw(10) << left << "Items" << setw(14) << "Full list us" << setw(14) << "Scan us"
+         << setw(14) << "Prefix us" << setw(14) << "Fuzzy us" << "\n";
+    for (size_t size : sizes) {
+        auto inventory = make_shared<vector<InventoryItem>>();
+        for (size_t i = 0; i < size; ++i) {
+            inventory->push_back({words[i % 16] + "-" + dishes[i / 16 % 16] + "-" + to_string(i), 10, 2.5});
+        }
+        ItemSearchIndex search(inventory);
+
+        vector<string> prefixes, typos;
+        for (int i = 0; i < lookups; ++i) {
+            const string &name = (*inventory)[(static_cast<size_t>(i) * 7919) % size].itemName;
+            prefixes.push_back(name.substr(0, 8 + i % 4));
+            string typo = name.substr(0, 10);
+            swap(typo[2], typo[3]); // A transposed pair, two edits
+            typos.push_back(typo);
+        }
+
+        size_t found = 0;
+        auto start = Clock::now();
+        for (int i = 0; i < 20; ++i) {
+            for (size_t item = 0; item < inventory->size(); ++item) {
+                const InventoryItem &entry = (*inventory)[item];
+                discard << item + 1 << ". " << entry.itemName << " (Price: $" << entry.price
+                        << ", Available Quantity: " << entry.quantity << ")\n";
+            }
+        }
+        double listUs = chrono::duration<double, micro>(Clock::now() - start).count() / 20;
+
+        start = Clock::now();
+        for (const auto &query : prefixes) {
+            string key = EmployeeStore::foldCase(query);
+            size_t matches = 0;
+            for (const auto &entry : *inventory) {
+                if (EmployeeStore::foldCase(entry.itemName).compare(0, key.size(), key) == 0 && matches < 10) {
+                    ++matches;
+                }
+            }
+            found += matches;
+        }
+        double scanUs = chrono::duration<double, micro>(Clock::now() - start).count() / lookups;
+
+        start = Clock::now();
+        for (const auto &query : prefixes) {
+            found += search.prefix(query, 10).size();
+        }
+        double prefixUs = chrono::duration<double, micro>(Clock::now() - start).count() / lookups;
+
+        start = Clock::now();
+        size_t fuzzyFound = 0;
+        for (const auto &query : typos) {
+            fuzzyFound += !search.fuzzy(query, 10).empty();
+        }
+        double fuzzyUs = chrono::duration<double, micro>(Clock::now() - start).count() / lookups;
+
+        if (found == 0 || fuzzyFound != static_cast<size_t>(lookups)) {
+            cout << "Benchmark self-check failed.\n";
+            return;
+        }
+        cout << fixed << setprecision(2) << setw(10) << left << size << setw(14) << listUs << setw(14) << scanUs
+             << setw(14) << prefixUs << setw(14) << fuzzyUs << "\n";
+    }
+}
+
+// Per-record latency of saving orders while the disk stalls: writing on the
+// caller's thread against handing records to AsyncJournal under each
+// backpressure policy and two ring sizes. The "disk" is a FIFO whose reader
+// stops for 50 ms out of every 100 ms; orders arrive at 100k/s in bursts of 20.
+// Returns false if the bytes that reached the disk do not match what was kept.
+bool benchWriter(size_t records) {
+    using Clock = chrono::steady_clock;
+    using Backpressure = AsyncJournal::Backpressure;
+    char dir[] = "/tmp/canteen-writer-XXXXXX";
+    if (mkdtemp(dir) == nullptr) {
+        cout << "Unable to create a scratch directory for the benchmark.\n";
+        return false;
+    }
+    const string fifoPath = string(dir) + "/orders.fifo";
+    const string row = "1760000000,7,2,0,2,1.5,3,1,1.5";
+
+    auto slowDisk = [&fifoPath](atomic<size_t> *bytes) {
+        int fd = ::open(fifoPath.c_str(), O_RDONLY);
+        char buffer[65536];
+        auto stallAt = Clock::now() + chrono::milliseconds(50);
+        for (ssize_t n; (n = ::read(fd, buffer, sizeof(buffer))) > 0;) {
+            bytes->fetch_add(static_cast<size_t>(n));
+            if (Clock::now() >= stallAt) {
+                this_thread::sleep_for(chrono::milliseconds(50));
+                stallAt = Clock::now() + chrono::milliseconds(50);
+            }
+        }
+        ::close(fd);
+    };
+
+    struct Variant {
+        string name;
+        size_t ring; // 0 writes on the caller's thread
+        Backpressure policy;
+    };
+    const Variant variants[] = {{"sync", 0, Backpressure::Block},
+                                {"async block", 4096, Backpressure::Block},
+                                {"async drop", 4096, Backpressure::Drop},
+                                {"async spill", 4096, Backpressure::Spill},
+                                {"async block", 256, Backpressure::Block},
+                                {"async drop", 256, Backpressure::Drop},
+                                {"async spill", 256, Backpressure::Spill}};
+
+    bool passed = true;
+    cout << "Records: " << records << "\n";
+    cout << setw(14) << left << "Mode" << setw(8) << "Ring" << setw(10) << "p50 us" << setw(10) << "p99 us"
+         << setw(12) << "p99.9 us" << setw(12) << "max us" << setw(10) << "Dropped" << "Drain ms" << "\n";
+    for (const auto &variant : variants) {
+        if (mkfifo(fifoPath.c_str(), 0600) != 0) {
+            cout << "Unable to create " << fifoPath << ".\n";
+            return false;
+        }
+        atomic<size_t> bytes{0};
+        thread reader(slowDisk, &bytes);
+        vector<double> us;
+        us.reserve(records);
+        size_t dropped = 0;
+        double drainMs = 0.0;
+        {
+            JournalWriter journal(fifoPath, JournalWriter::Durability::Flush);
+            unique_ptr<AsyncJournal> queue;
+            if (variant.ring > 0) {
+                queue.reset(new AsyncJournal(variant.ring, variant.policy));
+            }
+            auto next = Clock::now();
+            for (size_t i = 0; i < records; ++i) {
+                if (i % 20 == 0) {
+                    next += chrono::microseconds(200);
+                    this_thread::sleep_until(next);
+                }
+                auto start = Clock::now();
+                if (!queue) {
+                    journal.append(row);
+                    journal.commit();
+                } else if (!queue->submit(journal, row)) {
+                    ++dropped;
+                }
+                us.push_back(chrono::duration<double, micro>(Clock::now() - start).count());
+            }
+            auto start = Clock::now();
+            if (queue) {
+                queue->shutdown();
+            }
+            drainMs = chrono::duration<double, milli>(Clock::now() - start).count();
+        }
+        reader.join();
+        unlink(fifoPath.c_str());
+
+        sort(us.begin(), us.end());
+        cout << fixed << setprecision(1) << setw(14) << left << variant.name << setw(8)
+             << (variant.ring > 0 ? to_string(variant.ring) : "-") << setw(10) << us[us.size() / 2]
+             << setw(10) << us[us.size() * 99 / 100] << setw(12) << us[us.size() * 999 / 1000] << setw(12) << us.back()
+             << setw(10) << dropped << drainMs << "\n";
+        if (bytes.load() != (records - dropped) * (row.size() + 1)) {
+            cout << "Benchmark self-check failed: " << bytes.load() << " bytes reached the disk.\n";
+            passed = false;
+        }
+    }
+    rmdir(dir);
+    return passed;
+}
+
+// Overselling stress test and orders/s scaling for OrderEngine; returns false if stock was oversold
+bool benchOrderEngine() {
+    using Clock = chrono::steady_clock;
+
+    // 64 threads race for one hot item until it is gone
+    const int hotStock = 200000;
+    const int threadsForStress = 64;
+    OrderEngine hot({{"HotItem", hotStock, 2.5}});
+    vector<long long> sold(threadsForStress, 0);
+    vector<thread> workers;
+    for (int t = 0; t < threadsForStress; ++t) {
+        workers.emplace_back([&hot, &sold, t] {
+            double total;
+            for (int i = 0;; ++i) {
+                int quantity = 1 + (i + t) % 3;
+                if (hot.placeOrder(t, {{0, quantity}}, total)) {
+                    sold[t] += quantity;
+                } else if (hot.placeOrder(t, {{0, 1}}, total)) {
+                    sold[t] += 1;
+                } else {
+                    break;
+                }
+            }
+        });
+    }
+    for (auto &worker : workers) {
+        worker.join();
+    }
+    long long totalSold = 0;
+    for (long long n : sold) {
+        totalSold += n;
+    }
+    bool passed = totalSold == hotStock && hot.stock(0) == 0;
+    cout << "Hot item stress (" << threadsForStress << " threads): sold " << totalSold << " of " << hotStock
+         << ", left " << hot.stock(0) << (passed ? " - PASS" : " - FAIL: oversold") << "\n";
+
+    // Scaling across threads, orders spread over 64 items
+    vector<InventoryItem> items;
+    for (int i = 0; i < 64; ++i) {
+        items.push_back({"Item" + to_string(i), 1 << 30, 1.0 + i});
+    }
+    const int ordersPerThread = 200000;
+    unsigned maxThreads = max(4u, thread::hardware_concurrency());
+    vector<unsigned> threadCounts;
+    for (unsigned threads = 1; threads < maxThreads; threads *= 2) {
+        threadCounts.push_back(threads);
+    }
+    threadCounts.push_back(maxThreads);
+    cout << setw(10) << left << "Threads" << "Orders/s" << "\n";
+    for (unsigned threads : threadCounts) {
+        OrderEngine engine(items);
+        workers.clear();
+        auto start = Clock::now();
+        for (unsigned t = 0; t < threads; ++t) {
+            workers.emplace_back([&engine, t] {
+                double total;
+                for (int i = 0; i < ordersPerThread; ++i) {
+                    size_t first = (t * 7 + i) % 64;
+                    engine.placeOrder(static_cast<int>(t), {{first, 1}, {(first + 13) % 64, 2}}, total);
+                }
+            });
+        }
+        for (auto &worker : workers) {
+            worker.join();
+        }
+        double sec = chrono::duration<double>(Clock::now() - start).count();
+        cout << setw(10) << left << threads << static_cast<long long>(threads * ordersPerThread / sec) << "\n";
+    }
+    return passed;
+}
+
+// Every Admin and Employee operation at the given data size.
+// Runs in a scratch directory so the CSV and log files start empty.
+void benchOperations(size_t records) {
+    const int viewCalls = 20;
+    string allPages; // Answers every page prompt so the views print the whole table
+    for (size_t rows = 0; rows < records; rows += 20) {
+        allPages += "n\n";
+    }
+    filesystem::path startDir = filesystem::current_path();
+    char dir[] = "/tmp/canteen-bench-XXXXXX";
+    if (mkdtemp(dir) == nullptr || chdir(dir) != 0) {
+        cout << "Unable to create a scratch directory for the benchmark.\n";
+        return;
+    }
+
+    OpsBenchmark bench("test2", records);
+    NullBuffer nullBuffer;
+    streambuf *console = cout.rdbuf(&nullBuffer);
+    {
+        Admin admin("admin", "admin123");
+        for (size_t i = 0; i < records; ++i) {
+            bench.replay("add-employee", "Emp" + to_string(i) + "\n30\n" + to_string(i) + "\n1000\n",
+                         [&admin] { admin.addEmployee(); });
+        }
+        for (size_t i = 0; i < records; ++i) {
+            bench.replay("edit-employee", to_string(i) + "\nEmp" + to_string(i) + "\n31\n1100\n",
+                         [&admin] { admin.editEmployee(); });
+        }
+        for (int i = 0; i < viewCalls; ++i) {
+            bench.replay("view-employees", allPages, [&admin] { admin.viewEmployees(); });
+        }
+        for (size_t i = 0; i < records; ++i) {
+            bench.replay("add-item", "Item" + to_string(i) + "\n100\n1.5\n", [&admin] { admin.addItemToInventory(); });
+        }
+        for (int i = 0; i < viewCalls; ++i) {
+            bench.replay("view-inventory", allPages, [&admin] { admin.viewInventory(); });
+        }
+        for (size_t i = 0; i < records; ++i) {
+            string input = i % 2 ? "1\nEmp" + to_string(i) + "\n" : "2\n" + to_string(i) + "\n";
+            bench.replay("delete-employee", input, [&admin] { admin.deleteEmployee(); });
+        }
+    }
+    {
+        Employee emp("bench", 1, "password");
+        for (size_t i = 0; i < records; ++i) {
+            bench.replay("order", "Item" + to_string(i) + "\n1\n0\n", [&emp] { emp.orderItems(); });
+        }
+    }
+    {
+        Admin admin("bench", "password");
+        for (int i = 0; i < viewCalls; ++i) {
+            bench.replay("view-orders", "", [&admin] { admin.viewOrders(); });
+        }
+    }
+    cout.rdbuf(console);
+    bench.report(cout);
+    filesystem::current_path(startDir);
+    filesystem::remove_all(dir);
+}
+
+// Converts a CSV inventory (merging duplicate rows) into the binary format
+int convertInventory(const string &csvPath, const string &binaryPath) {
+    uint64_t checkpoint = 0;
+    vector<InventoryItem> merged;
+    unordered_map<string, size_t> slots;
+    for (const auto &item : loadInventoryCsv(csvPath, true, &checkpoint)) {
+        auto it = slots.find(item.itemName);
+        if (it == slots.end()) {
+            slots.emplace(item.itemName, merged.size());
+            merged.push_back(item);
+        } else {
+            merged[it->second].quantity += item.quantity;
+            merged[it->second].price = item.price;
+        }
+    }
+    if (!BinaryInventory::write(binaryPath, merged, checkpoint)) {
+        cout << "Unable to write " << binaryPath << ".\n";
+        return 1;
+    }
+    cout << "Wrote " << merged.size() << " items to " << binaryPath << ".\n";
+    return 0;
+}
+
+// Startup cost of the CSV snapshot against the memory-mapped binary one.
+// Returns false if the binary file moved an item or cannot find one by name.
+bool benchBinaryInventory(size_t items) {
+    using Clock = chrono::steady_clock;
+    const string csvPath = "bench_inv.csv";
+    const string binaryPath = "bench_inv.bin";
+    vector<InventoryItem> inventory;
+    inventory.reserve(items);
+    {
+        ofstream outFile(csvPath);
+        for (size_t i = 0; i < items; ++i) {
+            inventory.push_back({"Item" + to_string(i), static_cast<int>(i % 500), (i % 100) * 0.25});
+            outFile << inventory.back().itemName << "," << inventory.back().quantity << "," << inventory.back().price << "\n";
+        }
+    }
+    BinaryInventory::write(binaryPath, inventory, 0);
+
+    auto start = Clock::now();
+    vector<InventoryItem> fromCsv = loadInventoryCsv(csvPath);
+    double csvMs = chrono::duration<double, milli>(Clock::now() - start).count();
+
+    start = Clock::now();
+    BinaryInventory binary(binaryPath);
+    double openMs = chrono::duration<double, milli>(Clock::now() - start).count();
+
+    // What viewInventory does: touch every row
+    start = Clock::now();
+    long long quantity = 0;
+    size_t nameBytes = 0;
+    for (size_t i = 0; i < binary.size(); ++i) {
+        quantity += binary.quantity(i);
+        nameBytes += binary.name(i).size();
+    }
+    double scanMs = chrono::duration<double, milli>(Clock::now() - start).count();
+
+    // Item IDs are record numbers, so every item must stay where it was written
+    bool ok = fromCsv.size() == items && binary.size() == items && nameBytes > 0 && quantity >= 0;
+    for (size_t i = 0; ok && i < items; i += 1 + items / 1000) {
+        ok = binary.name(i) == inventory[i].itemName && binary.find(inventory[i].itemName) == static_cast<ptrdiff_t>(i);
+    }
+    ok = ok && binary.find("No such item") < 0;
+
+    remove(csvPath.c_str());
+    remove(binaryPath.c_str());
+    if (!ok) {
+        cout << "Benchmark self-check failed: the binary inventory lost or moved an item.\n";
+        return false;
+    }
+    cout << setw(12) << left << "Items" << setw(16) << "CSV load ms" << setw(16) << "mmap open ms"
+         << setw(16) << "mmap scan ms" << "\n";
+    cout << fixed << setprecision(3) << setw(12) << left << items << setw(16) << csvMs << setw(16) << openMs
+         << setw(16) << scanMs << "\n";
+    return true;
+}
+
+// Startup after a crash: replaying a log of the given length that ends in a
+// torn record, then logging one more change and replaying again. Returns
+// false if the torn record was applied or the new change did not survive.
+bool benchInventoryRecovery(size_t records) {
+    using Clock = chrono::steady_clock;
+    char dir[] = "/tmp/canteen-recovery-XXXXXX";
+    if (mkdtemp(dir) == nullptr) {
+        cout << "Unable to create a scratch directory for the benchmark.\n";
+        return false;
+    }
+    const string base = string(dir) + "/inv";
+    auto openStore = [&base] {
+        return make_unique<InventoryStore>(base + ".bin", base + ".csv", base + ".wal", base + "_settings.csv");
+    };
+    records = max<size_t>(records, 1);
+    {
+        ofstream log(base + ".wal");
+        log << "1,Tea,5,2.5\n";
+        for (size_t lsn = 2; lsn <= records; ++lsn) {
+            log << lsn << ",Tea,1,\n";
+        }
+        log << records + 1 << ",Tea,-"; // Crashed mid-write
+        ofstream emptySnapshot(base + ".csv");
+    }
+    int tea = static_cast<int>(records) + 4;
+
+    auto start = Clock::now();
+    bool ok;
+    {
+        auto store = openStore();
+        InventoryStore::Snapshot items = store->items();
+        ok = items->size() == 1 && (*items)[0].quantity == tea;
+        ok = store->addStock("Coffee", 10, 3.0) && ok;
+    }
+    double replayMs = chrono::duration<double, milli>(Clock::now() - start).count();
+    {
+        auto store = openStore();
+        InventoryStore::Snapshot items = store->items();
+        ok = ok && items->size() == 2 && (*items)[0].quantity == tea && (*items)[1].itemName == "Coffee" &&
+             (*items)[1].quantity == 10;
+    }
+
+    remove((base + ".wal").c_str());
+    remove((base + ".csv").c_str());
+    remove((base + ".bin").c_str());
+    rmdir(dir);
+    cout << "Log records: " << records << ", replay and one change after a torn write: " << fixed
+         << setprecision(2) << replayMs << " ms\n";
+    cout.unsetf(ios::fixed);
+    if (!ok) {
+        cout << "Benchmark self-check failed: the log did not recover from a torn record.\n";
+    }
+    return ok;
+}
+
+// Orders placed before the inventory is rewritten: items added out of name
+// order, one ordered, then enough changes to compact the log and a
+// --convert-inventory of the new CSV snapshot. Returns false if the order
+// read back afterwards names a different item.
+bool benchOrdersAcrossCompaction(size_t changes) {
+    using Clock = chrono::steady_clock;
+    char dir[] = "/tmp/canteen-orders-XXXXXX";
+    if (mkdtemp(dir) == nullptr) {
+        cout << "Unable to create a scratch directory for the benchmark.\n";
+        return false;
+    }
+    const string base = string(dir) + "/inv";
+    const string ordersPath = string(dir) + "/orders.csv";
+    auto openStore = [&base] {
+        return make_unique<InventoryStore>(base + ".bin", base + ".csv", base + ".wal", base + "_settings.csv");
+    };
+    { ofstream emptySnapshot(base + ".csv"); }
+
+    bool ok;
+    double compactMs;
+    {
+        auto store = openStore();
+        ok = store->addStock("Zebra", 10, 1.0) && store->addStock("Apple", 10, 2.0);
+        JournalWriter &journal = JournalWriter::forFile(ordersPath);
+        {
+            OrderEngine engine(*store->items(), store.get(), &journal, 1);
+            double total;
+            ok = ok && engine.itemName(0) == "Zebra" && engine.placeOrder(7, {{0, 3}}, total);
+        }
+        journal.flush();
+
+        auto start = Clock::now();
+        for (size_t i = 0; i < changes; ++i) {
+            ok = store->addStock("Apple", 1, 2.0) && ok;
+        }
+        compactMs = chrono::duration<double, milli>(Clock::now() - start).count();
+    }
+    error_code ec;
+    ok = ok && filesystem::exists(base + ".bin", ec); // The log was compacted
+    ok = ok && convertInventory(base + ".csv", base + ".bin") == 0;
+
+    OrderLog log;
+    if (ok && loadOrders(ordersPath, log) && log.records.size() == 1 && log.records[0].lines.size() == 1) {
+        auto store = openStore();
+        const OrderRecord::Line &line = log.records[0].lines[0];
+        ok = itemNameOf(*store->items(), line.itemID) == "Zebra" && line.quantity == 3;
+    } else {
+        ok = false;
+    }
+
+    for (const char *suffix : {".bin", ".csv", ".wal"}) {
+        remove((base + suffix).c_str());
+    }
+    remove(ordersPath.c_str());
+    rmdir(dir);
+    cout << "Inventory changes: " << changes << ", with compaction: " << fixed << setprecision(2) << compactMs
+         << " ms\n";
+    cout.unsetf(ios::fixed);
+    if (!ok) {
+        cout << "Benchmark self-check failed: an order named a different item after compaction.\n";
+    }
+    return ok;
+}
+
+// Low-stock, valuation and per-category reports at the given size: an
+// array of structs against InventoryColumns with the scalar and AVX2 kernels.
+// Returns false if the three disagree.
+bool benchInventoryReports(size_t items) {
+    using Clock = chrono::steady_clock;
+    struct StockRecord {
+        string itemName;
+        int quantity;
+        double price;
+        int reorderLevel;
+        uint32_t category;
+    };
+    const uint32_t categoryCount = 12;
+    const int runs = 5;
+
+    vector<StockRecord> records;
+    records.reserve(items);
+    InventoryColumns columns;
+    columns.categoryNames.resize(categoryCount);
+    for (size_t i = 0; i < items; ++i) {
+        int quantity = static_cast<int>((i * 7919) % 500);
+        double price = (i % 100) * 0.25;
+        uint32_t category = static_cast<uint32_t>(i % categoryCount);
+        records.push_back({"Item" + to_string(i), quantity, price, 20, category});
+        columns.push_back(quantity, price, 20, category);
+    }
+
+    // Best of several runs, in milliseconds
+    auto time = [runs](auto fn) {
+        double best = 0.0;
+        for (int run = 0; run < runs; ++run) {
+            auto start = Clock::now();
+            fn();
+            double ms = chrono::duration<double, milli>(Clock::now() - start).count();
+            best = run == 0 ? ms : min(best, ms);
+        }
+        return best;
+    };
+
+    vector<uint32_t> lowAos, lowScalar, lowSimd;
+    double valueAos = 0.0, valueScalar = 0.0, valueSimd = 0.0;
+    vector<double> byCategoryAos, byCategoryScalar, byCategorySimd;
+    const bool simd = cpuHasAvx2();
+
+    double lowMs[3] = {
+        time([&] {
+            lowAos.clear();
+            for (size_t i = 0; i < records.size(); ++i) {
+                if (records[i].quantity < records[i].reorderLevel) {
+                    lowAos.push_back(static_cast<uint32_t>(i));
+                }
+            }
+        }),
+        time([&] { lowScalar.clear(); lowStockScalar(columns, lowScalar); }),
+        time([&] { lowSimd.clear(); lowStockItems(columns, lowSimd); })};
+    double valueMs[3] = {
+        time([&] {
+            valueAos = 0.0;
+            for (const auto &record : records) {
+                valueAos += record.quantity * record.price;
+            }
+        }),
+        time([&] { valueScalar = stockValueScalar(columns); }),
+        time([&] { valueSimd = stockValue(columns); })};
+    double categoryMs[3] = {
+        time([&] {
+            byCategoryAos.assign(categoryCount, 0.0);
+            for (const auto &record : records) {
+                byCategoryAos[record.category] += record.quantity * record.price;
+            }
+        }),
+        time([&] { byCategoryScalar = categoryValuesScalar(columns); }),
+        time([&] { byCategorySimd = categoryValues(columns); })};
+
+    auto close = [](double a, double b) { return fabs(a - b) <= 1e-9 * max(1.0, fabs(a)); };
+    bool agree = lowAos == lowScalar && lowScalar == lowSimd && close(valueAos, valueScalar) &&
+                 valueScalar == valueSimd && byCategoryScalar == byCategorySimd;
+    for (size_t i = 0; i < categoryCount; ++i) {
+        agree = agree && close(byCategoryAos[i], byCategoryScalar[i]);
+    }
+
+    cout << "Items: " << items << (simd ? " (AVX2)" : " (no AVX2, scalar kernels only)") << "\n";
+    cout << setw(16) << left << "Report" << setw(14) << "Structs ms" << setw(14) << "Columns ms"
+         << setw(14) << "SIMD ms" << "Speedup" << "\n";
+    auto row = [](const string &report, const double (&ms)[3]) {
+        cout << fixed << setprecision(2) << setw(16) << left << report << setw(14) << ms[0] << setw(14) << ms[1]
+             << setw(14) << ms[2] << ms[0] / ms[2] << "x\n";
+    };
+    row("low-stock", lowMs);
+    row("valuation", valueMs);
+    row("by-category", categoryMs);
+    if (!agree) {
+        cout << "Benchmark self-check failed: reports disagree.\n";
+    }
+    return agree;
+}
+
+// Employee table output: the old setw/endl stream path against TableWriter in
+// each format, written to a file and to /dev/null
+bool benchTables(size_t rows) {
+    using Clock = chrono::steady_clock;
+    char dir[] = "/tmp/canteen-table-XXXXXX";
+    if (mkdtemp(dir) == nullptr) {
+        cout << "Unable to create a scratch directory for the benchmark.\n";
+        return false;
+    }
+    const string filePath = string(dir) + "/employees.out";
+
+    vector<EmployeeStore::EmployeeData> employees;
+    employees.reserve(rows);
+    for (size_t i = 0; i < rows; ++i) {
+        employees.push_back({"Employee" + to_string(i), 20 + static_cast<int>(i % 60), static_cast<int>(i),
+                             1000.0 + static_cast<double>(i % 5000) * 0.5});
+    }
+
+    auto oldPath = [&employees](ostream &out) {
+        out << "\n=============================================\n";
+        out << setw(10) << left << "Name" << setw(10) << "Age" << setw(10) << "ID" << setw(10) << "Salary" << endl;
+        out << "=============================================\n";
+        for (const auto &emp : employees) {
+            out << setw(10) << left << emp.name
+                << setw(10) << emp.age
+                << setw(10) << emp.empID
+                << "$" << setw(9) << emp.salary << endl;
+        }
+        out << "=============================================\n";
+    };
+    // Building the table is part of every TableWriter run
+    auto tablePath = [&employees](TableWriter::Format format) {
+        return [&employees, format](ostream &out) {
+            TableWriter table({"Name", "Age", "ID", "Salary"});
+            table.setPrefix(3, "$");
+            for (const auto &emp : employees) {
+                table.add(emp.name).add(emp.age).add(emp.empID).add(emp.salary);
+            }
+            table.render(out, format);
+        };
+    };
+    struct Variant {
+        string name;
+        function<void(ostream &)> write;
+    };
+    const Variant variants[] = {{"setw+endl", oldPath},
+                                {"table", tablePath(TableWriter::Format::Text)},
+                                {"csv", tablePath(TableWriter::Format::Csv)},
+                                {"json", tablePath(TableWriter::Format::Json)}};
+
+    cout << "Rows: " << rows << "\n";
+    cout << setw(12) << left << "Output" << setw(14) << "File ms" << setw(14) << "/dev/null ms" << "File MB" << "\n";
+    for (const auto &variant : variants) {
+        double ms[2];
+        const string sinks[] = {filePath, "/dev/null"};
+        for (int sink = 0; sink < 2; ++sink) {
+            ofstream out(sinks[sink], ios::trunc);
+            auto start = Clock::now();
+            variant.write(out);
+            out.flush();
+            ms[sink] = chrono::duration<double, milli>(Clock::now() - start).count();
+        }
+        double mb = static_cast<double>(filesystem::file_size(filePath)) / (1024.0 * 1024.0);
+        cout << fixed << setprecision(1) << setw(12) << left << variant.name << setw(14) << ms[0] << setw(14) << ms[1]
+             << mb << "\n";
+        cout.unsetf(ios::fixed);
+    }
+    remove(filePath.c_str());
+    rmdir(dir);
+    return true;
+}
+
+// Appends rows orders spread over a year, 500 employees and 1000 items to path,
+// numbering them from firstOrder
+void writeSampleOrders(const string &path, size_t rows, size_t firstOrder = 0) {
+    ofstream out(path, ios::binary | ios::app);
+    OrderRecord order;
+    string row, block;
+    for (size_t i = firstOrder; i < firstOrder + rows; ++i) {
+        order.timestamp = 1700000000 + static_cast<int64_t>(i * 2654435761ULL % 31536000);
+        order.employeeID = 1 + static_cast<int>(i * 7 % 500);
+        order.lines.clear();
+        for (size_t line = 0; line <= i % 3; ++line) {
+            uint32_t item = static_cast<uint32_t>((i * 31 + line * 17) % 1000);
+            order.lines.push_back({item, 1 + static_cast<int>((i + line) % 4), 0.25 * (1 + item % 40)});
+        }
+        order.format(row);
+        block += row;
+        block += '\n';
+        if (block.size() >= (1 << 20)) {
+            out.write(block.data(), static_cast<streamsize>(block.size()));
+            block.clear();
+        }
+    }
+    out.write(block.data(), static_cast<streamsize>(block.size()));
+}
+
+// True if both reports hold the same totals
+bool sameSales(const SalesReport &a, const SalesReport &b) {
+    auto same = [](const SalesReport::Totals &x, const SalesReport::Totals &y) {
+        return x.orders == y.orders && x.quantity == y.quantity && x.revenueCents == y.revenueCents;
+    };
+    auto sameMaps = [&same](const auto &x, const auto &y) {
+        if (x.size() != y.size()) {
+            return false;
+        }
+        for (const auto &entry : x) {
+            auto found = y.find(entry.first);
+            if (found == y.end() || !same(entry.second, found->second)) {
+                return false;
+            }
+        }
+        return true;
+    };
+    bool agree = same(a.overall, b.overall) && sameMaps(a.items, b.items) && sameMaps(a.employees, b.employees) &&
+                 sameMaps(a.days, b.days) && a.legacyRows == b.legacyRows;
+    for (int hour = 0; hour < 24; ++hour) {
+        agree = agree && same(a.hours[hour], b.hours[hour]);
+    }
+    return agree;
+}
+
+// Sales analytics over a generated orders file at several thread counts.
+// Every run must produce the same totals.
+bool benchSales(size_t rows) {
+    using Clock = chrono::steady_clock;
+    char dir[] = "/tmp/canteen-sales-XXXXXX";
+    if (mkdtemp(dir) == nullptr) {
+        cout << "Unable to create a scratch directory for the benchmark.\n";
+        return false;
+    }
+    const string path = string(dir) + "/orders.csv";
+    writeSampleOrders(path, rows);
+    const double gb = static_cast<double>(filesystem::file_size(path)) / 1e9;
+
+    const unsigned cores = max(1u, thread::hardware_concurrency());
+    vector<unsigned> threadCounts{1, 2, 4, 8};
+    if (find(threadCounts.begin(), threadCounts.end(), cores) == threadCounts.end()) {
+        threadCounts.push_back(cores);
+    }
+
+    cout << "Rows: " << rows << ", " << fixed << setprecision(2) << gb << " GB, " << cores << " cores\n";
+    cout << setw(10) << left << "Threads" << setw(12) << "ms" << "GB/s" << "\n";
+    SalesReport first;
+    bool agree = true;
+    for (unsigned threads : threadCounts) {
+        SalesReport report;
+        auto start = Clock::now();
+        report.load(path, threads);
+        double ms = chrono::duration<double, milli>(Clock::now() - start).count();
+        cout << setw(10) << threads << setw(12) << setprecision(1) << ms << setprecision(2) << gb / (ms / 1000.0)
+             << "\n";
+        if (threads == threadCounts.front()) {
+            first = move(report);
+            agree = first.overall.orders == rows && first.errors.empty();
+            continue;
+        }
+        agree = agree && sameSales(first, report);
+    }
+    cout.unsetf(ios::fixed);
+    remove(path.c_str());
+    rmdir(dir);
+    if (!agree) {
+        cout << "Benchmark self-check failed: thread counts disagree.\n";
+    }
+    return agree;
+}
+
+// Keeping the sales summary current: a full rescan against catching up on a
+// startup tail, and the cost the summary adds to every committed order
+bool benchSalesSummary(size_t rows) {
+    using Clock = chrono::steady_clock;
+    const size_t tailRows = 1000;
+    const size_t commits = 10000;
+    char dir[] = "/tmp/canteen-summary-XXXXXX";
+    if (mkdtemp(dir) == nullptr) {
+        cout << "Unable to create a scratch directory for the benchmark.\n";
+        return false;
+    }
+    const string ordersPath = string(dir) + "/orders.csv";
+    const string summaryPath = string(dir) + "/sales_summary.csv";
+    writeSampleOrders(ordersPath, rows);
+    auto ms = [](Clock::time_point start) { return chrono::duration<double, milli>(Clock::now() - start).count(); };
+    auto rescan = [&ordersPath] {
+        SalesReport report;
+        report.load(ordersPath);
+        return report;
+    };
+
+    auto start = Clock::now();
+    SalesReport full = rescan();
+    double rescanMs = ms(start);
+
+    start = Clock::now();
+    { SalesSummary summary(summaryPath, ordersPath); }
+    double buildMs = ms(start);
+
+    writeSampleOrders(ordersPath, tailRows, rows);
+    start = Clock::now();
+    bool agree;
+    double startupMs;
+    {
+        SalesSummary summary(summaryPath, ordersPath);
+        startupMs = ms(start);
+        agree = sameSales(summary.totals(), rescan());
+    }
+
+    // Each commit writes one order; with the summary open it also folds the order in
+    JournalWriter &journal = JournalWriter::forFile(ordersPath);
+    journal.setDurability(JournalWriter::Durability::Flush);
+    OrderRecord order;
+    order.employeeID = 7;
+    order.lines.push_back({3, 2, 1.5});
+    double commitUs[2];
+    for (int withSummary = 0; withSummary < 2; ++withSummary) {
+        unique_ptr<SalesSummary> summary(withSummary ? new SalesSummary(summaryPath, ordersPath) : nullptr);
+        start = Clock::now();
+        for (size_t i = 0; i < commits; ++i) {
+            order.timestamp = 1760000000 + static_cast<int64_t>(i);
+            order.writeTo(journal);
+        }
+        commitUs[withSummary] = ms(start) * 1000.0 / commits;
+        if (summary) {
+            agree = agree && sameSales(summary->totals(), rescan());
+        }
+    }
+
+    // A summary saved before item IDs were stable is rebuilt even though its checkpoint is current
+    {
+        error_code ec;
+        ofstream legacy(summaryPath, ios::trunc);
+        legacy << "#checkpoint," << filesystem::file_size(ordersPath, ec) << ",0,0\nitem,3,1,1,1\n";
+    }
+    {
+        SalesSummary summary(summaryPath, ordersPath);
+        agree = agree && sameSales(summary.totals(), rescan());
+    }
+
+    cout << "Rows: " << rows << ", then " << tailRows << " appended\n" << fixed << setprecision(1);
+    cout << setw(34) << left << "Full rescan of orders.csv" << rescanMs << " ms\n";
+    cout << setw(34) << left << "First summary build" << buildMs << " ms\n";
+    cout << setw(34) << left << "Startup catch-up on the new tail" << setprecision(2) << startupMs << " ms\n";
+    cout << setw(34) << left << "Order commit without summary" << commitUs[0] << " us\n";
+    cout << setw(34) << left << "Order commit with summary" << commitUs[1] << " us\n";
+    cout.unsetf(ios::fixed);
+    remove(ordersPath.c_str());
+    remove(summaryPath.c_str());
+    rmdir(dir);
+    if (!agree) {
+        cout << "Benchmark self-check failed: the summary disagrees with a full rescan.\n";
+    }
+    return agree;
+}
+
+// Employee registry at the given size: edits and deletes as single slot writes
+// against rewriting the whole employee file for each change, and reopening
+// after a background compaction
+bool benchEmployeeRegistry(size_t employees) {
+    using Clock = chrono::steady_clock;
+    using EmployeeData = EmployeeStore::EmployeeData;
+    const size_t edits = 10000;
+    const int rewrites = 20;
+    char dir[] = "/tmp/canteen-registry-XXXXXX";
+    if (mkdtemp(dir) == nullptr) {
+        cout << "Unable to create a scratch directory for the benchmark.\n";
+        return false;
+    }
+    const string path = string(dir) + "/employees.dat";
+    const string csvPath = string(dir) + "/employee_details.csv";
+    auto us = [](Clock::time_point start, size_t calls) {
+        return chrono::duration<double, micro>(Clock::now() - start).count() / static_cast<double>(calls);
+    };
+
+    map<int, EmployeeData> expected;
+    for (size_t i = 0; i < employees; ++i) {
+        int id = static_cast<int>(i);
+        expected[id] = {"Emp" + to_string(i), 20 + id % 60, id, 1000.0 + id % 500};
+    }
+
+    double editUs, rewriteUs, deleteUs, loadMs;
+    size_t bytesBefore, bytesAfter, deleted = 0;
+    {
+        EmployeeRegistry registry(path);
+        for (const auto &entry : expected) {
+            registry.put(entry.second);
+        }
+
+        auto start = Clock::now();
+        for (size_t i = 0; i < edits; ++i) {
+            EmployeeData &emp = expected[static_cast<int>(i * 7919 % employees)];
+            emp.salary += 1.0;
+            registry.put(emp);
+        }
+        editUs = us(start, edits);
+
+        // The alternative: rewrite every row of the employee file for each change
+        start = Clock::now();
+        for (int i = 0; i < rewrites; ++i) {
+            ofstream out(csvPath, ios::trunc);
+            for (const auto &entry : expected) {
+                out << JournalWriter::format(entry.second.name, entry.second.age, entry.second.empID,
+                                             entry.second.salary) << '\n';
+            }
+        }
+        rewriteUs = us(start, rewrites);
+
+        // Deleting three in five leaves more tombstones than live slots, which starts a compaction
+        bytesBefore = static_cast<size_t>(filesystem::file_size(path));
+        start = Clock::now();
+        for (auto it = expected.begin(); it != expected.end();) {
+            if (it->first % 5 < 3) {
+                registry.remove(it->first);
+                it = expected.erase(it);
+                ++deleted;
+            } else {
+                ++it;
+            }
+        }
+        deleteUs = us(start, max<size_t>(deleted, 1));
+    } // Waits for the compaction to finish
+    bytesAfter = static_cast<size_t>(filesystem::file_size(path));
+
+    auto start = Clock::now();
+    EmployeeRegistry reopened(path);
+    vector<EmployeeData> loaded = reopened.employees();
+    loadMs = chrono::duration<double, milli>(Clock::now() - start).count();
+
+    // Deletes made after the compaction started stay as tombstones until the next one
+    bool agree = loaded.size() == expected.size() && reopened.tombstoneCount() < deleted / 2;
+    for (const auto &emp : loaded) {
+        auto found = expected.find(emp.empID);
+        agree = agree && found != expected.end() && found->second.name == emp.name &&
+                found->second.age == emp.age && found->second.salary == emp.salary;
+    }
+
+    cout << "Employees: " << employees << "\n" << fixed << setprecision(2);
+    cout << setw(36) << left << "Edit, slot rewritten in place" << editUs << " us\n";
+    cout << setw(36) << left << "Edit, whole file rewritten" << rewriteUs << " us\n";
+    cout << setw(36) << left << "Delete, tombstone" << deleteUs << " us\n";
+    cout << setw(36) << left << "File before and after compaction" << bytesBefore / 1024 << " KB -> "
+         << bytesAfter / 1024 << " KB\n";
+    cout << setw(36) << left << "Reopen after compaction" << loadMs << " ms\n";
+    cout.unsetf(ios::fixed);
+    remove(path.c_str());
+    remove((path + ".lock").c_str());
+    remove(csvPath.c_str());
+    rmdir(dir);
+    if (!agree) {
+        cout << "Benchmark self-check failed: the reopened registry does not match.\n";
+    }
+    return agree;
+}
+
+int main(int argc, char *argv[]) {
+    // Converter: ./test2 --convert-inventory [inv.csv [inv.bin]]
+    if (argc > 1 && string(argv[1]) == "--convert-inventory") {
+        return convertInventory(argc > 2 ? argv[2] : "inv.csv", argc > 3 ? argv[3] : "inv.bin");
+    }
+
+    // Export: ./test2 --export employees|inventory [table|csv|tsv|json] [file]
+    if (argc > 2 && string(argv[1]) == "--export") {
+        string what = argv[2];
+        TableWriter::Format format = TableWriter::Format::Csv;
+        if ((what != "employees" && what != "inventory") || (argc > 3 && !TableWriter::parseFormat(argv[3], format))) {
+            cerr << "Usage: " << argv[0] << " --export employees|inventory [table|csv|tsv|json] [file]\n";
+            return 1;
+        }
+        ofstream file;
+        if (argc > 4) {
+            file.open(argv[4], ios::trunc);
+            if (!file) {
+                cerr << "Unable to open " << argv[4] << " for writing.\n";
+                return 1;
+            }
+        }
+        ostream &out = argc > 4 ? file : cout;
+        if (what == "employees") {
+            Admin("admin", "admin123").employeeTable().render(out, format);
+        } else {
+            Admin::inventoryTable().render(out, format);
+        }
+        return out.flush() ? 0 : 1;
+    }
+
+    // Benchmarks: ./test2 --bench [employees | csv [rows] | journal | writer [records] | search | engine |
+    //                             ops [records] | binary [items] | recovery [records] | compaction [changes] |
+    //                             reports [items] | table [rows] |
+    //                             sales [rows] | summary [rows] | registry [employees]]
+    if (argc > 1 && string(argv[1]) == "--bench") {
+        string which = argc > 2 ? argv[2] : "all";
+        if (which == "employees" || which == "all") {
+            benchEmployeeStore();
+        }
+        if (which == "csv" || which == "all") {
+            benchCsvParse(argc > 3 ? stoul(argv[3]) : 10000000);
+        }
+        if (which == "journal" || which == "all") {
+            benchJournal();
+        }
+        if (which == "search" || which == "all") {
+            benchItemSearch();
+        }
+        if ((which == "writer" || which == "all") && !benchWriter(argc > 3 ? stoul(argv[3]) : 50000)) {
+            return 1;
+        }
+        if ((which == "engine" || which == "all") && !benchOrderEngine()) {
+            return 1;
+        }
+        if ((which == "binary" || which == "all") && !benchBinaryInventory(argc > 3 ? stoul(argv[3]) : 1000000)) {
+            return 1;
+        }
+        if ((which == "recovery" || which == "all") && !benchInventoryRecovery(argc > 3 ? stoul(argv[3]) : 100000)) {
+            return 1;
+        }
+        if ((which == "compaction" || which == "all") && !benchOrdersAcrossCompaction(argc > 3 ? stoul(argv[3]) : 2000)) {
+            return 1;
+        }
+        if ((which == "reports" || which == "all") && !benchInventoryReports(argc > 3 ? stoul(argv[3]) : 10000000)) {
+            return 1;
+        }
+        if ((which == "table" || which == "all") && !benchTables(argc > 3 ? stoul(argv[3]) : 1000000)) {
+            return 1;
+        }
+        if ((which == "sales" || which == "all") && !benchSales(argc > 3 ? stoul(argv[3]) : 20000000)) {
+            return 1;
+        }
+        if ((which == "summary" || which == "all") && !benchSalesSummary(argc > 3 ? stoul(argv[3]) : 2000000)) {
+            return 1;
+        }
+        if ((which == "registry" || which == "all") && !benchEmployeeRegistry(argc > 3 ? stoul(argv[3]) : 100000)) {
+            return 1;
+        }
+        if (which == "ops" || which == "all") {
+            benchOperations(argc > 3 ? stoul(argv[3]) : 1000);
+        }
+        return 0;
+    }
+
+    startStatsSignalThread();
+    SalesSummary::instance(); // Folds in orders appended since the last run
+    EmployeeRegistry::instance(); // Loads every employee once
+
     int userType;
     cout << "Welcome to Canteen Management System\n";
     cout << "1. Admin\n2. Employee\nChoose user type: ";